@@ -19,10 +19,39 @@ cmd.AddValue(
     topologyFilePtr,
     BUFFLEN
 )
+traceFormatBuffer = create_string_buffer(b"ascii", BUFFLEN)
+traceFormatPtr = c_char_p(traceFormatBuffer.raw)
+cmd.AddValue(
+    "traceFormat",
+    "Trace output: ascii (aloha.tr), binary (aloha.trb) or columnar (aloha.time, aloha.delay, ...)",
+    traceFormatPtr,
+    BUFFLEN
+)
+asyncTraceBuffer = create_string_buffer(b"off", BUFFLEN)
+asyncTracePtr = c_char_p(asyncTraceBuffer.raw)
+cmd.AddValue(
+    "asyncTrace",
+    "Write traces on a background thread: off, block (lossless) or drop (never stalls)",
+    asyncTracePtr,
+    BUFFLEN
+)
+metricsWindowBuffer = create_string_buffer(b"", BUFFLEN)
+metricsWindowPtr = c_char_p(metricsWindowBuffer.raw)
+cmd.AddValue(
+    "metricsWindow",
+    "Also write windowed metrics to aloha.metrics, e.g. 100ms (plot.py --metrics)",
+    metricsWindowPtr,
+    BUFFLEN
+)
 cmd.Parse(sys.argv)
 
 topologyFilePath = topologyFilePtr.value.decode()
 assert topologyFilePath != ""
+traceFormat = traceFormatPtr.value.decode()
+assert traceFormat in ("ascii", "binary", "columnar")
+asyncTrace = asyncTracePtr.value.decode()
+assert asyncTrace in ("off", "block", "drop")
+metricsWindow = metricsWindowPtr.value.decode()
 
 ns.Config.SetDefault("ns3::ConfigStore::Filename", ns.StringValue("attributes.txt"))
 ns.Config.SetDefault("ns3::ConfigStore::FileFormat", ns.StringValue("RawText"))
@@ -51,10 +80,22 @@ mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel")
 mobility.Install(nodes)
 
 aloha = ns.AlohaHelper()
-ascii = ns.AsciiTraceHelper()
-stream = ascii.CreateFileStream("aloha.tr")
 devices = aloha.Install(nodes)
-aloha.EnableAsciiAll(stream)
+aloha.AssignStreams(devices, 0)
+if asyncTrace == "block":
+    aloha.SetAsyncTrace(65536, ns.AlohaAsyncTraceWriter.BLOCK)
+elif asyncTrace == "drop":
+    aloha.SetAsyncTrace(65536, ns.AlohaAsyncTraceWriter.DROP)
+if traceFormat == "binary":
+    aloha.EnableBinaryAll("aloha.trb")
+elif traceFormat == "columnar":
+    aloha.EnableColumnarAll("aloha")
+else:
+    ascii = ns.AsciiTraceHelper()
+    stream = ascii.CreateFileStream("aloha.tr")
+    aloha.EnableAsciiAll(stream)
+if metricsWindow != "":
+    aloha.EnableMetricsAll("aloha.metrics", ns.Time(metricsWindow))
 
 internet = ns.InternetStackHelper()
 internet.Install(nodes)
@@ -70,4 +111,6 @@ clientApps = echoClient.Install(nodes)
 
 ns.Simulator.Stop(ns.Seconds(10))
 ns.Simulator.Run()
+print("Delay table peak:", aloha.GetDelayTablePeak(), "packets")
+print("Trace records dropped:", aloha.GetTraceRecordsDropped())
 ns.Simulator.Destroy()
@@ -0,0 +1,321 @@
+/*
+ * Cross-validation of AlohaKernel against the ns-3 model. Builds the
+ * aloha.py scenario, runs it in ns-3, then runs the standalone kernel on
+ * the same topology, attributes and RNG streams and compares throughput
+ * and delay distributions (quantiles and a two-sample Kolmogorov-Smirnov
+ * test).
+ *
+ *   ./ns3 run "aloha-kernel-validate --topology=topologies/7node_connected.txt"
+ *
+ * With --mode=kernel only the kernel runs, once per RngRun in
+ * [RngRun, RngRun + runs), for bulk exploration.
+ */
+
+#include "ns3/core-module.h"
+#include "ns3/network-module.h"
+#include "ns3/mobility-module.h"
+#include "ns3/internet-module.h"
+#include "ns3/applications-module.h"
+#include "ns3/config-store-module.h"
+#include "ns3/propagation-delay-model.h"
+#include "ns3/aloha-helper.h"
+#include "ns3/aloha-header.h"
+#include "ns3/aloha-net_device.h"
+#include "ns3/aloha-kernel.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <fstream>
+#include <iomanip>
+#include <map>
+#include <sstream>
+
+using namespace ns3;
+
+NS_LOG_COMPONENT_DEFINE ("AlohaKernelValidate");
+
+/* IPv4 and UDP headers in front of the echo client's payload */
+static const uint32_t IP_UDP_HEADERS = 28;
+
+static std::map<uint64_t, Time> g_enqueued;
+static std::vector<double> g_delays;
+static uint64_t g_bytes = 0;
+
+static void
+Enqueue (Ptr<const Packet> packet)
+{
+    g_enqueued[packet->GetUid ()] = Simulator::Now ();
+}
+
+static void
+AckReceive (Ptr<const Packet> packet)
+{
+    AlohaMacPacketTag tag;
+    packet->PeekPacketTag (tag);
+    g_delays.push_back ((Simulator::Now () - g_enqueued.at (tag.GetPacketUid ())).GetSeconds ());
+    g_bytes += tag.GetPacketSize ();
+}
+
+struct Summary
+{
+    uint64_t deliveries;
+    double throughput;
+    double mean;
+    std::vector<double> delays;
+    double seconds;
+};
+
+static double
+Quantile (const std::vector<double> &sorted, double q)
+{
+    if (sorted.empty ())
+    {
+        return 0.0;
+    }
+    return sorted[std::min<std::size_t> (sorted.size () - 1, std::size_t (q * sorted.size ()))];
+}
+
+/* two-sample Kolmogorov-Smirnov statistic of sorted samples */
+static double
+KolmogorovSmirnov (const std::vector<double> &a, const std::vector<double> &b)
+{
+    std::size_t i = 0;
+    std::size_t j = 0;
+    double d = 0.0;
+    while (i < a.size () && j < b.size ())
+    {
+        double x = std::min (a[i], b[j]);
+        while (i < a.size () && a[i] <= x)
+        {
+            i++;
+        }
+        while (j < b.size () && b[j] <= x)
+        {
+            j++;
+        }
+        d = std::max (d, std::fabs (double (i) / a.size () - double (j) / b.size ()));
+    }
+    return d;
+}
+
+static Summary
+Summarize (std::vector<double> delays, uint64_t bytes, Time stop, double seconds)
+{
+    Summary summary;
+    std::sort (delays.begin (), delays.end ());
+    summary.deliveries = delays.size ();
+    summary.throughput = bytes * 8.0 / stop.GetSeconds () / 1e6;
+    summary.mean = 0.0;
+    for (double delay : delays)
+    {
+        summary.mean += delay;
+    }
+    if (!delays.empty ())
+    {
+        summary.mean /= delays.size ();
+    }
+    summary.delays = delays;
+    summary.seconds = seconds;
+    return summary;
+}
+
+static Summary
+RunKernel (AlohaKernel &kernel, const AlohaKernel::Config &config, Time stop)
+{
+    auto start = std::chrono::steady_clock::now ();
+    kernel.Run ();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+
+    std::vector<double> delays;
+    uint64_t bytes = 0;
+    for (const AlohaKernel::Delivery &delivery : kernel.GetDeliveries ())
+    {
+        delays.push_back (double (delivery.delay) / config.stepsPerSecond);
+        bytes += delivery.size;
+    }
+    return Summarize (delays, bytes, stop, elapsed.count ());
+}
+
+int
+main (int argc, char *argv[])
+{
+    std::string topology;
+    std::string mode = "validate";
+    uint32_t runs = 1;
+    double stopTime = 10.0;
+
+    CommandLine cmd (__FILE__);
+    cmd.AddValue ("topology", "The topology file containing the coordinates of each node", topology);
+    cmd.AddValue ("mode", "validate (ns-3 and kernel) or kernel (kernel only)", mode);
+    cmd.AddValue ("runs", "Kernel runs in kernel mode, from RngRun on", runs);
+    cmd.AddValue ("stopTime", "Simulated seconds", stopTime);
+    cmd.Parse (argc, argv);
+
+    NS_ABORT_MSG_IF (topology.empty (), "No topology given");
+    NS_ABORT_MSG_UNLESS (mode == "validate" || mode == "kernel", "Unknown mode " << mode);
+
+    Config::SetDefault ("ns3::ConfigStore::Filename", StringValue ("attributes.txt"));
+    Config::SetDefault ("ns3::ConfigStore::FileFormat", StringValue ("RawText"));
+    Config::SetDefault ("ns3::ConfigStore::Mode", StringValue ("Load"));
+    ConfigStore inputConfig;
+    inputConfig.ConfigureDefaults ();
+    inputConfig.ConfigureAttributes ();
+
+    Ptr<ListPositionAllocator> allocator = CreateObject<ListPositionAllocator> ();
+    std::ifstream file (topology);
+    NS_ABORT_MSG_UNLESS (file.is_open (), "Cannot open " << topology);
+    std::string line;
+    uint32_t numNodes = 0;
+    while (std::getline (file, line))
+    {
+        std::istringstream xyz (line);
+        Vector position;
+        if (xyz >> position.x >> position.y >> position.z)
+        {
+            allocator->Add (position);
+            numNodes++;
+        }
+    }
+
+    NodeContainer nodes (numNodes);
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator (allocator);
+    mobility.SetMobilityModel ("ns3::ConstantPositionMobilityModel");
+    mobility.Install (nodes);
+
+    AlohaHelper aloha;
+    NetDeviceContainer devices = aloha.Install (nodes);
+    aloha.AssignStreams (devices, 0);
+
+    InternetStackHelper internet;
+    internet.Install (nodes);
+
+    Ipv4AddressHelper address;
+    address.SetBase (Ipv4Address ("10.0.0.0"), Ipv4Mask ("255.255.255.0"));
+    Ipv4InterfaceContainer interfaces = address.Assign (devices);
+
+    UdpEchoClientHelper echoClient (interfaces.GetAddress (0), 9);
+    ApplicationContainer clientApps = echoClient.Install (nodes);
+
+    // Everything the kernel needs is read back from the configured objects.
+    Ptr<AlohaNetDevice> device = DynamicCast<AlohaNetDevice> (devices.Get (0));
+    Ptr<AlohaMac> mac = device->GetMac ();
+    Ptr<WirelessPhy> phy = device->GetPhy ();
+    Ptr<WirelessChannel> channel = phy->GetChannel ();
+    Ptr<Application> client = clientApps.Get (0);
+
+    NS_ABORT_MSG_IF (phy->GetPacketErrorRate () != 0.0 || phy->GetBitErrorRate () != 0.0,
+                     "AlohaKernel does not model the PHY error model");
+
+    PointerValue delayModel;
+    channel->GetAttribute ("PropagationDelayModel", delayModel);
+    Ptr<ConstantSpeedPropagationDelayModel> constantSpeed =
+        delayModel.Get<ConstantSpeedPropagationDelayModel> ();
+    NS_ABORT_MSG_UNLESS (constantSpeed, "AlohaKernel needs a constant-speed delay model");
+
+    DoubleValue range;
+    UintegerValue packetSize;
+    UintegerValue maxPackets;
+    TimeValue interval;
+    UintegerValue backoffFactor;
+    BooleanValue collisions;
+    channel->GetAttribute ("TransmissionRange", range);
+    client->GetAttribute ("PacketSize", packetSize);
+    client->GetAttribute ("MaxPackets", maxPackets);
+    client->GetAttribute ("Interval", interval);
+    mac->GetAttribute ("BackoffFactor", backoffFactor);
+    phy->GetAttribute ("EnableCollisions", collisions);
+
+    AlohaKernel::Config config;
+    config.sink = nodes.GetN ();
+    for (uint32_t i = 0; i < nodes.GetN (); i++)
+    {
+        config.positions.push_back (nodes.Get (i)->GetObject<MobilityModel> ()->GetPosition ());
+        if (Mac48Address::ConvertFrom (devices.Get (i)->GetAddress ()) == mac->GetSinkAddress ())
+        {
+            config.sink = i;
+        }
+    }
+    NS_ABORT_MSG_IF (config.sink == nodes.GetN (), "No node has the sink address");
+
+    config.range = range.Get ();
+    config.speed = constantSpeed->GetSpeed ();
+    config.stepsPerSecond = Seconds (1).GetTimeStep ();
+    config.packetSize = packetSize.Get () + IP_UDP_HEADERS;
+    config.dataAirtime = phy->GetTransmissionTime (config.packetSize + AlohaHeader::SERIALIZED_SIZE).GetTimeStep ();
+    config.ackAirtime = mac->GetAckTime ().GetTimeStep ();
+    config.enableCollisions = collisions.Get ();
+    config.maxPackets = maxPackets.Get ();
+    config.queueSize = mac->GetQueueCapacity ();
+    config.interval = interval.Get ().GetTimeStep ();
+    config.startTime = 0;
+    config.stopTime = Seconds (stopTime).GetTimeStep ();
+    config.minBackoffExponent = mac->GetMinBackoffExponent ();
+    config.maxBackoffExponent = mac->GetMaxBackoffExponent ();
+    config.backoffFactor = backoffFactor.Get ();
+    config.jitter = mac->GetJitter ();
+    config.usePriorityAck = mac->GetUsePriorityAck ();
+    config.useCarrierSensing = mac->GetUseCarrierSensing ();
+    config.slotted = mac->IsSlotted ();
+    config.slotTime = mac->GetSlotTime ().GetTimeStep ();
+    config.seed = RngSeedManager::GetSeed ();
+    config.run = RngSeedManager::GetRun ();
+    config.stream = 0;
+
+    AlohaKernel kernel (config);
+    Time stop = Seconds (stopTime);
+
+    if (mode == "kernel")
+    {
+        std::cout << "run deliveries throughput(Mbps) mean_delay(s) p50(s) p90(s) wall(s)" << std::endl;
+        for (uint32_t r = 0; r < runs; r++)
+        {
+            kernel.SetRun (config.run + r);
+            Summary summary = RunKernel (kernel, config, stop);
+            std::cout << config.run + r << " " << summary.deliveries << " " << summary.throughput
+                      << " " << summary.mean << " " << Quantile (summary.delays, 0.5) << " "
+                      << Quantile (summary.delays, 0.9) << " " << summary.seconds << std::endl;
+        }
+        Simulator::Destroy ();
+        return 0;
+    }
+
+    for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i)
+    {
+        Ptr<AlohaMac> m = DynamicCast<AlohaNetDevice> (*i)->GetMac ();
+        m->TraceConnectWithoutContext ("Enqueue", MakeCallback (&Enqueue));
+        m->TraceConnectWithoutContext ("AckReceive", MakeCallback (&AckReceive));
+    }
+
+    auto start = std::chrono::steady_clock::now ();
+    Simulator::Stop (stop);
+    Simulator::Run ();
+    std::chrono::duration<double> elapsed = std::chrono::steady_clock::now () - start;
+    Simulator::Destroy ();
+
+    Summary model = Summarize (g_delays, g_bytes, stop, elapsed.count ());
+    Summary fast = RunKernel (kernel, config, stop);
+
+    double d = KolmogorovSmirnov (model.delays, fast.delays);
+    double n = model.delays.size ();
+    double m = fast.delays.size ();
+    double critical = (n > 0 && m > 0) ? 1.358 * std::sqrt ((n + m) / (n * m)) : 0.0;
+
+    std::cout << std::setw (22) << "" << std::setw (14) << "ns-3" << std::setw (14) << "kernel" << std::endl;
+    std::cout << std::setw (22) << "deliveries" << std::setw (14) << model.deliveries << std::setw (14) << fast.deliveries << std::endl;
+    std::cout << std::setw (22) << "throughput (Mbps)" << std::setw (14) << model.throughput << std::setw (14) << fast.throughput << std::endl;
+    std::cout << std::setw (22) << "mean delay (s)" << std::setw (14) << model.mean << std::setw (14) << fast.mean << std::endl;
+    for (double q : {0.1, 0.5, 0.9, 0.99})
+    {
+        std::ostringstream label;
+        label << "p" << q * 100 << " delay (s)";
+        std::cout << std::setw (22) << label.str () << std::setw (14) << Quantile (model.delays, q)
+                  << std::setw (14) << Quantile (fast.delays, q) << std::endl;
+    }
+    std::cout << std::setw (22) << "wall clock (s)" << std::setw (14) << model.seconds << std::setw (14) << fast.seconds << std::endl;
+    std::cout << "KS statistic " << d << " (5% critical value " << critical << "): "
+              << (d <= critical ? "PASS" : "FAIL") << std::endl;
+
+    return d <= critical ? 0 : 1;
+}
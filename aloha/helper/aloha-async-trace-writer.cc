@@ -0,0 +1,127 @@
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "aloha-async-trace-writer.h"
+
+#include <chrono>
+#include <iostream>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AlohaAsyncTraceWriter");
+
+/* idle polls before the consumer starts sleeping between them */
+static const uint32_t SPIN_POLLS = 64;
+
+AlohaAsyncTraceWriter::AlohaAsyncTraceWriter(Ptr<AlohaTraceWriter> writer, uint32_t capacity,
+                                             Backpressure backpressure)
+    : m_writer(writer),
+      m_backpressure(backpressure),
+      m_head(0),
+      m_tail(0),
+      m_stop(false)
+{
+    NS_ASSERT(m_writer);
+    NS_ASSERT(capacity > 0);
+
+    uint64_t size = 1;
+    while (size < capacity) {
+        size *= 2;
+    }
+    m_ring.resize(size);
+    m_mask = size - 1;
+    m_cachedTail = 0;
+    m_dropped = 0;
+    m_closed = false;
+
+    m_thread = std::thread(&AlohaAsyncTraceWriter::Drain, this);
+}
+
+AlohaAsyncTraceWriter::~AlohaAsyncTraceWriter()
+{
+    Close();
+}
+
+void
+AlohaAsyncTraceWriter::Write(const AlohaTraceRecord &record)
+{
+    NS_ASSERT_MSG(!m_closed, "Trace written after Close");
+
+    uint64_t head = m_head.load(std::memory_order_relaxed);
+    if (head - m_cachedTail > m_mask) {
+        m_cachedTail = m_tail.load(std::memory_order_acquire);
+        while (head - m_cachedTail > m_mask) {
+            if (m_backpressure == DROP) {
+                m_dropped++;
+                return;
+            }
+            std::this_thread::yield();
+            m_cachedTail = m_tail.load(std::memory_order_acquire);
+        }
+    }
+
+    m_ring[head & m_mask] = record;
+    m_head.store(head + 1, std::memory_order_release);
+}
+
+void
+AlohaAsyncTraceWriter::Drain(void)
+{
+    uint64_t tail = m_tail.load(std::memory_order_relaxed);
+    uint32_t idle = 0;
+
+    while (true) {
+        // read the stop flag first, so a final pass sees every record
+        bool stop = m_stop.load(std::memory_order_acquire);
+        uint64_t head = m_head.load(std::memory_order_acquire);
+
+        if (head == tail) {
+            if (stop) {
+                break;
+            }
+            if (++idle < SPIN_POLLS) {
+                std::this_thread::yield();
+            } else {
+                std::this_thread::sleep_for(std::chrono::microseconds(100));
+            }
+            continue;
+        }
+
+        idle = 0;
+        while (tail != head) {
+            m_writer->Write(m_ring[tail & m_mask]);
+            tail++;
+            // hand slots back as we go, so a blocked producer resumes early
+            if ((tail & 1023) == 0) {
+                m_tail.store(tail, std::memory_order_release);
+            }
+        }
+        m_tail.store(tail, std::memory_order_release);
+    }
+}
+
+void
+AlohaAsyncTraceWriter::Close(void)
+{
+    if (m_closed) {
+        return;
+    }
+    m_closed = true;
+
+    m_stop.store(true, std::memory_order_release);
+    m_thread.join();
+    m_writer->Close();
+
+    if (m_dropped > 0) {
+        // the trace is incomplete, so say so even with logging compiled out
+        std::cerr << "AlohaAsyncTraceWriter: dropped " << m_dropped
+                  << " trace records on a full ring" << std::endl;
+    }
+}
+
+uint64_t
+AlohaAsyncTraceWriter::GetDropped(void) const
+{
+    return m_dropped;
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,68 @@
+#ifndef SLOTTED_ALOHA_ASYNC_TRACE_WRITER_H
+#define SLOTTED_ALOHA_ASYNC_TRACE_WRITER_H
+
+#include <stdint.h>
+#include <atomic>
+#include <thread>
+#include <vector>
+
+#include "ns3/ptr.h"
+#include "ns3/aloha-trace-writer.h"
+
+namespace ns3 {
+
+/*
+ * Moves another writer's encoding and I/O onto a background thread.
+ *
+ * The simulator thread only copies each record into a single-producer,
+ * single-consumer ring; the thread drains the ring into the wrapped
+ * writer. When the ring is full, BLOCK waits for space, so no record is
+ * lost, while DROP discards the record and counts it, so the simulation
+ * never waits on the disk.
+ *
+ * The wrapped writer must not be used by anyone else until Close, which
+ * drains the ring, stops the thread and then closes it.
+ */
+class AlohaAsyncTraceWriter : public AlohaTraceWriter {
+
+public:
+
+    enum Backpressure {
+        BLOCK,
+        DROP
+    };
+
+    AlohaAsyncTraceWriter(Ptr<AlohaTraceWriter> writer, uint32_t capacity = 65536,
+                          Backpressure backpressure = BLOCK);
+    ~AlohaAsyncTraceWriter();
+
+    void Write(const AlohaTraceRecord &record) override;
+    void Close(void) override;
+
+    /* records discarded under DROP */
+    uint64_t GetDropped(void) const;
+
+private:
+
+    void Drain(void);
+
+    Ptr<AlohaTraceWriter> m_writer;
+    Backpressure m_backpressure;
+    std::vector<AlohaTraceRecord> m_ring;
+    uint64_t m_mask;
+
+    /* kept on separate cache lines, since each is written by one side */
+    alignas(64) std::atomic<uint64_t> m_head;   /* next record to write; producer */
+    alignas(64) std::atomic<uint64_t> m_tail;   /* next record to drain; consumer */
+    alignas(64) std::atomic<bool> m_stop;
+    uint64_t m_cachedTail;                      /* producer's last view of m_tail */
+    uint64_t m_dropped;
+
+    std::thread m_thread;
+    bool m_closed;
+
+}; /* class AlohaAsyncTraceWriter */
+
+} /* namespace ns3 */
+
+#endif /* SLOTTED_ALOHA_ASYNC_TRACE_WRITER_H */
@@ -0,0 +1,131 @@
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "aloha-delay-table.h"
+
+#include <algorithm>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AlohaDelayTable");
+
+AlohaDelayTable::AlohaDelayTable(uint32_t capacity)
+{
+    // keep the load factor at or below one half
+    uint32_t slots = 8;
+    while (slots < 2 * capacity) {
+        slots *= 2;
+    }
+
+    m_entries.resize(slots, Entry {0, false, Time(0)});
+    m_mask = slots - 1;
+    m_capacity = capacity;
+    m_size = 0;
+    m_peak = 0;
+}
+
+uint32_t
+AlohaDelayTable::GetHome(uint32_t uid) const
+{
+    // UIDs are sequential, so scatter them before masking
+    return (uid * 2654435761u) & m_mask;
+}
+
+uint32_t
+AlohaDelayTable::Find(uint32_t uid) const
+{
+    uint32_t i = GetHome(uid);
+    while (m_entries[i].used) {
+        if (m_entries[i].uid == uid) {
+            return i;
+        }
+        i = (i + 1) & m_mask;
+    }
+    return m_entries.size();
+}
+
+void
+AlohaDelayTable::Insert(uint32_t uid, Time enqueued)
+{
+    NS_ASSERT_MSG(Find(uid) == m_entries.size(), "We have already enqueued this packet UID somewhere");
+
+    if (2 * (m_size + 1) > m_entries.size()) {
+        Grow();
+    }
+
+    uint32_t i = GetHome(uid);
+    while (m_entries[i].used) {
+        i = (i + 1) & m_mask;
+    }
+    m_entries[i] = Entry {uid, true, enqueued};
+
+    m_size++;
+    m_peak = std::max(m_peak, m_size);
+}
+
+bool
+AlohaDelayTable::Remove(uint32_t uid, Time &enqueued)
+{
+    uint32_t i = Find(uid);
+    if (i == m_entries.size()) {
+        return false;
+    }
+    enqueued = m_entries[i].enqueued;
+
+    // Shift later members of the probe run back into the hole, unless
+    // they would then sit before their home slot.
+    uint32_t hole = i;
+    uint32_t j = (i + 1) & m_mask;
+    while (m_entries[j].used) {
+        uint32_t home = GetHome(m_entries[j].uid);
+        if (((j - home) & m_mask) >= ((j - hole) & m_mask)) {
+            m_entries[hole] = m_entries[j];
+            hole = j;
+        }
+        j = (j + 1) & m_mask;
+    }
+    m_entries[hole].used = false;
+
+    m_size--;
+    return true;
+}
+
+void
+AlohaDelayTable::Grow(void)
+{
+    NS_LOG_WARN("Delay table outgrew its capacity of " << m_capacity << " packets");
+
+    std::vector<Entry> entries;
+    entries.swap(m_entries);
+    m_entries.resize(2 * entries.size(), Entry {0, false, Time(0)});
+    m_mask = m_entries.size() - 1;
+
+    for (const Entry &entry : entries) {
+        if (entry.used) {
+            uint32_t i = GetHome(entry.uid);
+            while (m_entries[i].used) {
+                i = (i + 1) & m_mask;
+            }
+            m_entries[i] = entry;
+        }
+    }
+}
+
+uint32_t
+AlohaDelayTable::GetSize(void) const
+{
+    return m_size;
+}
+
+uint32_t
+AlohaDelayTable::GetPeak(void) const
+{
+    return m_peak;
+}
+
+uint32_t
+AlohaDelayTable::GetCapacity(void) const
+{
+    return m_capacity;
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,60 @@
+#ifndef SLOTTED_ALOHA_DELAY_TABLE_H
+#define SLOTTED_ALOHA_DELAY_TABLE_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+
+namespace ns3 {
+
+/*
+ * Enqueue times of the packets one device has waiting, keyed by packet
+ * UID, for the ascii trace's delay column.
+ *
+ * An open-addressing table with linear probing and backward-shift
+ * deletion, so freed slots leave no tombstones behind. Entries are added
+ * once the MAC queue accepts a packet and removed when it is ACKed, so the
+ * table holds at most the queue's capacity and is sized for that up front;
+ * it only grows if that bound is broken.
+ */
+class AlohaDelayTable : public SimpleRefCount<AlohaDelayTable> {
+
+public:
+
+    AlohaDelayTable(uint32_t capacity);
+
+    void Insert(uint32_t uid, Time enqueued);
+
+    /* Removes uid, returning whether it was present and when it was enqueued */
+    bool Remove(uint32_t uid, Time &enqueued);
+
+    uint32_t GetSize(void) const;
+    uint32_t GetPeak(void) const;
+    uint32_t GetCapacity(void) const;
+
+private:
+
+    struct Entry
+    {
+        uint32_t uid;
+        bool used;
+        Time enqueued;
+    };
+
+    uint32_t Find(uint32_t uid) const;
+    uint32_t GetHome(uint32_t uid) const;
+    void Grow(void);
+
+    std::vector<Entry> m_entries;
+    uint32_t m_mask;
+    uint32_t m_capacity;
+    uint32_t m_size;
+    uint32_t m_peak;
+
+}; /* class AlohaDelayTable */
+
+} /* namespace ns3 */
+
+#endif /* SLOTTED_ALOHA_DELAY_TABLE_H */
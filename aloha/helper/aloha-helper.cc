@@ -4,18 +4,21 @@
 #include "ns3/aloha-mac.h"
 #include "ns3/wireless-channel.h"
 #include "ns3/aloha-net_device.h"
+#include "ns3/node-list.h"
+
+#include <algorithm>
 
 
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("AlohaHelper");
 
-std::map<uint32_t, Time> AlohaHelper::m_delays;
-
 AlohaHelper::AlohaHelper() {
 	m_deviceFactory.SetTypeId ("ns3::AlohaNetDevice");
 	m_phyFactory.SetTypeId ("ns3::WirelessPhy");
 	m_channelFactory.SetTypeId ("ns3::WirelessChannel");
+	m_asyncCapacity = 0;
+	m_asyncBackpressure = AlohaAsyncTraceWriter::BLOCK;
 }
 
 AlohaHelper::~AlohaHelper() {
@@ -84,6 +87,7 @@ AlohaHelper::AssignStreams (NetDeviceContainer c, int64_t stream)
 {
 	int64_t currentStream = stream;
 	Ptr<NetDevice> netDevice;
+	std::vector< Ptr<WirelessChannel> > channels;
 	for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i) {
 		netDevice = (*i);
 		Ptr<AlohaNetDevice> alohadevice = DynamicCast<AlohaNetDevice> (netDevice);
@@ -91,41 +95,194 @@ AlohaHelper::AssignStreams (NetDeviceContainer c, int64_t stream)
 		NS_ASSERT(alohadevice);
 		if (alohadevice) {
 			currentStream += alohadevice->AssignStreams (currentStream);
+
+			// channels are shared, so only assign each one once, in the
+			// order they are first seen
+			auto channel = alohadevice->GetPhy()->GetChannel();
+			if (std::find(channels.begin(), channels.end(), channel) == channels.end()) {
+				channels.push_back(channel);
+			}
 		}
 	}
+
+	for (auto channel : channels) {
+		currentStream += channel->AssignStreams (currentStream);
+	}
 	return (currentStream - stream);
 }
 
-void AlohaHelper::ReceiveSinkWithContext(Ptr<OutputStreamWrapper> stream,
-                                                std::string context,
-                                                Ptr<const Packet> p)
+void
+AlohaHelper::ReceiveSink(Ptr<AlohaTraceWriter> writer,
+                         Ptr<AlohaDelayTable> table,
+                         uint32_t node,
+                         Ptr<const Packet> p)
 {	
 	AlohaMacPacketTag tag;
 	p->PeekPacketTag(tag);
 
-	NS_ASSERT_MSG(m_delays.count(tag.GetPacketUid()) == true, "This packet should have been enqueued at a node.");
+	Time enqueued;
+	bool found = table->Remove(tag.GetPacketUid(), enqueued);
+	NS_ASSERT_MSG(found, "This packet should have been enqueued at a node.");
 
-	Time delay = Simulator::Now() - m_delays.at(tag.GetPacketUid());
-    NS_LOG_FUNCTION(stream << p);
-    *stream->GetStream() << "r " << Simulator::Now().GetSeconds() << " " << context << " " << delay.GetSeconds() << " " << tag.GetPacketSize()
-                         << std::endl;
-
-	
+    NS_LOG_FUNCTION(writer << p);
+    Time now = Simulator::Now();
+    writer->Write(AlohaTraceWriter::MakeReceive(now, node, now - enqueued, tag.GetPacketSize()));
 }
 
-void AlohaHelper::EnqueueSinkWithContext(Ptr<OutputStreamWrapper> stream,
-                                                std::string context,
-                                                Ptr<const Packet> p)
+void
+AlohaHelper::EnqueueSink(Ptr<AlohaTraceWriter> writer,
+                         uint32_t node,
+                         Ptr<const Packet> p)
 {	
-	AlohaMacPacketTag tag;
-	p->PeekPacketTag(tag);
+    NS_LOG_FUNCTION(writer << p);
+    writer->Write(AlohaTraceWriter::MakeEnqueue(Simulator::Now(), node));
+}
 
-    NS_LOG_FUNCTION(stream << p);
-    *stream->GetStream() << "+ " << Simulator::Now().GetSeconds() << " " << context << " "
-                         << std::endl;
-	
-	NS_ASSERT_MSG(m_delays.count(p->GetUid()) == false, "We have already enqueued this packet UID somewhere");
-	m_delays[p->GetUid()] = Simulator::Now();
+void
+AlohaHelper::QueueSink(Ptr<AlohaDelayTable> table, Ptr<const Packet> p)
+{
+	// only packets the queue accepted, so the table never outgrows it
+	table->Insert(p->GetUid(), Simulator::Now());
+}
+
+void
+AlohaHelper::ReportDelayTable(uint32_t node, Ptr<AlohaDelayTable> table)
+{
+	NS_LOG_INFO("Node " << node << " tracked at most " << table->GetPeak()
+	            << " packet delays (queue capacity " << table->GetCapacity() << ")");
+}
+
+void
+AlohaHelper::CloseWriter(Ptr<AlohaTraceWriter> writer)
+{
+	writer->Close();
+}
+
+void
+AlohaHelper::SetAsyncTrace(uint32_t capacity, AlohaAsyncTraceWriter::Backpressure backpressure)
+{
+	m_asyncCapacity = capacity;
+	m_asyncBackpressure = backpressure;
+}
+
+Ptr<AlohaTraceWriter>
+AlohaHelper::GetWriter(Ptr<AlohaTraceWriter> writer)
+{
+	// Each writer gets one wrapper and one close, however many devices or
+	// Enable* calls feed it; two rings draining into one writer would race.
+	auto found = m_writers.find(PeekPointer(writer));
+	if (found != m_writers.end()) {
+		return found->second;
+	}
+
+	Ptr<AlohaTraceWriter> outer = writer;
+	if (m_asyncCapacity > 0) {
+		outer = Create<AlohaAsyncTraceWriter>(writer, m_asyncCapacity, m_asyncBackpressure);
+	}
+	m_writers[PeekPointer(writer)] = outer;
+	Simulator::ScheduleDestroy(&AlohaHelper::CloseWriter, outer);
+	return outer;
+}
+
+void
+AlohaHelper::EnableTrace(Ptr<AlohaTraceWriter> writer, NetDeviceContainer devices)
+{
+	NS_ASSERT(writer);
+	writer = GetWriter(writer);
+	for (NetDeviceContainer::Iterator i = devices.Begin (); i != devices.End (); ++i) {
+		Ptr<AlohaNetDevice> device = DynamicCast<AlohaNetDevice> (*i);
+		if (device) {
+			m_delayTables.push_back(ConnectTrace(writer, device));
+		}
+	}
+}
+
+void
+AlohaHelper::EnableTraceAll(Ptr<AlohaTraceWriter> writer)
+{
+	NetDeviceContainer devices;
+	for (NodeList::Iterator i = NodeList::Begin (); i != NodeList::End (); ++i) {
+		for (uint32_t j = 0; j < (*i)->GetNDevices (); ++j) {
+			devices.Add ((*i)->GetDevice (j));
+		}
+	}
+	EnableTrace(writer, devices);
+}
+
+void
+AlohaHelper::EnableBinaryAll(std::string filename)
+{
+	EnableTraceAll(Create<AlohaBinaryTraceWriter>(filename));
+}
+
+void
+AlohaHelper::EnableColumnarAll(std::string prefix)
+{
+	EnableTraceAll(Create<AlohaColumnarTraceWriter>(prefix));
+}
+
+void
+AlohaHelper::EnableMetricsAll(std::string filename, Time window)
+{
+	AsciiTraceHelper ascii;
+	EnableTraceAll(Create<AlohaMetricsAggregator>(ascii.CreateFileStream(filename), window));
+}
+
+uint32_t
+AlohaHelper::GetDelayTablePeak(void) const
+{
+	uint32_t peak = 0;
+	for (auto table : m_delayTables) {
+		peak = std::max(peak, table->GetPeak());
+	}
+	return peak;
+}
+
+uint64_t
+AlohaHelper::GetTraceRecordsDropped(void) const
+{
+	uint64_t dropped = 0;
+	for (auto &writer : m_writers) {
+		Ptr<AlohaAsyncTraceWriter> async = DynamicCast<AlohaAsyncTraceWriter>(writer.second);
+		if (async) {
+			dropped += async->GetDropped();
+		}
+	}
+	return dropped;
+}
+
+Ptr<AlohaDelayTable>
+AlohaHelper::ConnectTrace(Ptr<AlohaTraceWriter> writer, Ptr<AlohaNetDevice> device)
+{
+	auto mac = device->GetMac();
+	NS_ASSERT_MSG(mac, "Attempted to attach trace to uninitialized device");
+
+	uint32_t node = device->GetNode()->GetId();
+
+	// one table per device, sized by its queue since entries leave with their packets
+	Ptr<AlohaDelayTable> table = Create<AlohaDelayTable>(mac->GetQueueCapacity());
+	Simulator::ScheduleDestroy(&AlohaHelper::ReportDelayTable, node, table);
+
+    bool result = mac->TraceConnectWithoutContext("AckReceive",
+                                       MakeBoundCallback(&AlohaHelper::ReceiveSink, writer, table, node));
+    NS_ASSERT_MSG(result == true,
+                  "Unable to hook \""
+                      << "AckReceive" << "\"");
+
+	result = mac->TraceConnectWithoutContext("Enqueue",
+										MakeBoundCallback(&AlohaHelper::EnqueueSink, writer, node));
+	NS_ASSERT_MSG(result == true,
+				" Unable to hook \""
+					<< "Enqueue" << "\"");
+
+	// The MAC's Enqueue fires before the queue has accepted the packet;
+	// the queue's own fires only once it has.
+	result = mac->GetQueue()->TraceConnectWithoutContext("Enqueue",
+										MakeBoundCallback(&AlohaHelper::QueueSink, table));
+	NS_ASSERT_MSG(result == true,
+				" Unable to hook the queue's \""
+					<< "Enqueue" << "\"");
+	return table;
 }
 
 void
@@ -164,26 +321,12 @@ AlohaHelper::EnableAsciiInternal(Ptr<OutputStreamWrapper> stream,
 		NS_FATAL_ERROR("No OutputStreamWrapper provided");
     }
 
-	AsciiTraceHelper asciiTraceHelper;
-
-	auto mac = device->GetMac();
-	NS_ASSERT_MSG(mac, "Attempted to attach trace to uninitialized device");
-
-	std::string nodeName = std::to_string(nd->GetNode()->GetId());
-
-    bool result = mac->TraceConnect("AckReceive",
-                                       nodeName,
-                                       MakeBoundCallback(&AlohaHelper::ReceiveSinkWithContext, stream));
-    NS_ASSERT_MSG(result == true,
-                  "Unable to hook \""
-                      << "AckReceive" << "\"");
-
-	result = mac->TraceConnect("Enqueue",
-										nodeName,
-										MakeBoundCallback(&AlohaHelper::EnqueueSinkWithContext, stream));
-	NS_ASSERT_MSG(result == true,
-				" Unable to hook \""
-					<< "AckReceive" << "\"");
+	// one writer per stream, so EnableAsciiAll shares it between devices
+	Ptr<AlohaTraceWriter> &writer = m_asciiWriters[PeekPointer(stream)];
+	if (!writer) {
+		writer = Create<AlohaAsciiTraceWriter>(stream);
+	}
+	m_delayTables.push_back(ConnectTrace(GetWriter(writer), device));
 
 	// asciiTraceHelper.HookDefaultReceiveSinkWithContext<AlohaMac>(mac, nodeName, "AckReceive", stream);
 	// asciiTraceHelper.HookDefaultEnqueueSinkWithContext<AlohaMac>(mac, nodeName, "Enqueue", stream);
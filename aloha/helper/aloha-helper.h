@@ -8,6 +8,14 @@
 #include "ns3/node-container.h"
 #include "ns3/wireless-channel.h"
 #include "ns3/wireless-phy.h"
+#include "ns3/aloha-delay-table.h"
+#include "ns3/aloha-trace-writer.h"
+#include "ns3/aloha-async-trace-writer.h"
+#include "ns3/aloha-metrics-aggregator.h"
+#include "ns3/aloha-net_device.h"
+
+#include <map>
+#include <vector>
 
 namespace ns3 {
 
@@ -24,13 +32,28 @@ public:
 	NetDeviceContainer Install (const NodeContainer &container) const;
 	NetDeviceContainer Install (const NodeContainer &container, Ptr<WirelessChannel> channel) const;
 
-    static void ReceiveSinkWithContext(Ptr<OutputStreamWrapper> stream,
-                                                    std::string context,
-                                                    Ptr<const Packet> p);
-                                                    
-    static void EnqueueSinkWithContext(Ptr<OutputStreamWrapper> stream,
-                                                    std::string context,
-                                                    Ptr<const Packet> p);    
+    /*
+     * Sends the trace records of the given devices to writer, which is
+     * closed when the simulation is destroyed. EnableAscii* is the same with
+     * an AlohaAsciiTraceWriter.
+     */
+    void EnableTrace(Ptr<AlohaTraceWriter> writer, NetDeviceContainer devices);
+    void EnableTraceAll(Ptr<AlohaTraceWriter> writer);
+    void EnableBinaryAll(std::string filename);
+    void EnableColumnarAll(std::string prefix);
+
+    /* Writes one row of windowed metrics per window rather than a trace;
+     * see AlohaMetricsAggregator. */
+    void EnableMetricsAll(std::string filename, Time window);
+
+    /*
+     * Writers enabled after this call are fed through an
+     * AlohaAsyncTraceWriter with a ring of the given capacity; zero, the
+     * default, writes on the simulator thread.
+     */
+    void SetAsyncTrace(uint32_t capacity,
+                       AlohaAsyncTraceWriter::Backpressure backpressure = AlohaAsyncTraceWriter::BLOCK);
+
     /**
      * \brief Enable ascii trace output on the indicated net device.
      *
@@ -49,13 +72,38 @@ public:
 
 	int64_t AssignStreams (NetDeviceContainer c, int64_t stream);
 
-    static std::map<uint32_t, Time> m_delays;
-    
+    /*
+     * The most packet delays any traced device had to track at once; at
+     * most its MAC queue capacity. Read it at the end of the run.
+     */
+    uint32_t GetDelayTablePeak(void) const;
+
+    /*
+     * Trace records the asynchronous writers discarded on a full ring; only
+     * nonzero with SetAsyncTrace(..., DROP).
+     */
+    uint64_t GetTraceRecordsDropped(void) const;
+
 private:
+
+    Ptr<AlohaTraceWriter> GetWriter(Ptr<AlohaTraceWriter> writer);
+    static Ptr<AlohaDelayTable> ConnectTrace(Ptr<AlohaTraceWriter> writer, Ptr<AlohaNetDevice> device);
+    static void ReceiveSink(Ptr<AlohaTraceWriter> writer, Ptr<AlohaDelayTable> table,
+                            uint32_t node, Ptr<const Packet> p);
+    static void EnqueueSink(Ptr<AlohaTraceWriter> writer, uint32_t node, Ptr<const Packet> p);
+    static void QueueSink(Ptr<AlohaDelayTable> table, Ptr<const Packet> p);
+    static void ReportDelayTable(uint32_t node, Ptr<AlohaDelayTable> table);
+    static void CloseWriter(Ptr<AlohaTraceWriter> writer);
                    
 	ObjectFactory m_deviceFactory;
 	ObjectFactory m_phyFactory;
 	ObjectFactory m_channelFactory;
+
+    uint32_t m_asyncCapacity;
+    AlohaAsyncTraceWriter::Backpressure m_asyncBackpressure;
+    std::map<AlohaTraceWriter *, Ptr<AlohaTraceWriter> > m_writers;
+    std::map<OutputStreamWrapper *, Ptr<AlohaTraceWriter> > m_asciiWriters;
+    std::vector< Ptr<AlohaDelayTable> > m_delayTables;
 };
 
 } /* namespace ns3 */
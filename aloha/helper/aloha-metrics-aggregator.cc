@@ -0,0 +1,129 @@
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "aloha-metrics-aggregator.h"
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AlohaMetricsAggregator");
+
+AlohaMetricsAggregator::AlohaMetricsAggregator(Ptr<OutputStreamWrapper> stream, Time window)
+    : m_stream(stream),
+      m_window(window.GetTimeStep()),
+      m_current(-1),
+      m_closed(false),
+      m_seen(0),
+      m_delivering(0),
+      m_backlog(0),
+      m_bytes(0),
+      m_received(0),
+      m_receivedSquares(0)
+{
+    NS_ASSERT(m_stream);
+    NS_ASSERT_MSG(m_window > 0, "The metrics window must be positive");
+
+    *m_stream->GetStream() << "time throughput delay fairness buffer" << '\n';
+}
+
+AlohaMetricsAggregator::NodeState &
+AlohaMetricsAggregator::GetNode(uint32_t node)
+{
+    if (node >= m_nodes.size()) {
+        m_nodes.resize(node + 1, NodeState{false, false, 0, 0, 0});
+    }
+    NodeState &state = m_nodes[node];
+    if (!state.seen) {
+        state.seen = true;
+        m_seen++;
+    }
+    return state;
+}
+
+void
+AlohaMetricsAggregator::Write(const AlohaTraceRecord &record)
+{
+    NS_ASSERT_MSG(!m_closed, "Trace written after Close");
+
+    int64_t index = record.time / m_window;
+    NS_ASSERT_MSG(index >= m_current, "Trace records out of time order");
+    if (m_current < 0) {
+        m_current = index;
+    }
+    while (m_current < index) {
+        Flush();
+    }
+
+    NodeState &state = GetNode(record.node);
+    if (record.event == AlohaTraceRecord::ENQUEUE) {
+        state.backlog++;
+        m_backlog++;
+        return;
+    }
+
+    state.backlog--;
+    m_backlog--;
+    if (!state.delivered) {
+        state.delivered = true;
+        m_delivering++;
+    }
+    if (state.received == 0) {
+        m_touched.push_back(record.node);
+    }
+    // (c + 1)^2 - c^2, so the squares never need summing at the end
+    m_receivedSquares += 2 * state.received + 1;
+    state.received++;
+    state.delaySum += record.delay;
+    m_received++;
+    m_bytes += record.size;
+}
+
+void
+AlohaMetricsAggregator::Flush(void)
+{
+    double seconds = TimeStep(m_window).GetSeconds();
+    double throughput = m_bytes * 8 / seconds / 1e6;
+
+    double delay = 0;
+    for (uint32_t node : m_touched) {
+        NodeState &state = m_nodes[node];
+        delay += TimeStep(state.delaySum).GetSeconds() / state.received;
+        state.received = 0;
+        state.delaySum = 0;
+    }
+
+    std::ostream &os = *m_stream->GetStream();
+    os << TimeStep(m_current * m_window).GetSeconds() << " " << throughput << " ";
+    if (m_touched.empty()) {
+        os << "nan";
+    } else {
+        os << delay / m_touched.size();
+    }
+
+    double fairness = 1;
+    if (m_received > 0) {
+        fairness = double(m_received) * m_received / (double(m_delivering) * m_receivedSquares);
+    }
+    double buffer = m_seen > 0 ? double(m_backlog) / m_seen : 0;
+    os << " " << fairness << " " << buffer << '\n';
+
+    m_touched.clear();
+    m_bytes = 0;
+    m_received = 0;
+    m_receivedSquares = 0;
+    m_current++;
+}
+
+void
+AlohaMetricsAggregator::Close(void)
+{
+    if (m_closed) {
+        return;
+    }
+    m_closed = true;
+
+    if (m_current >= 0) {
+        Flush();
+    }
+    m_stream->GetStream()->flush();
+}
+
+} /* namespace ns3 */
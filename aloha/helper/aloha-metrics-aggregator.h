@@ -0,0 +1,76 @@
+#ifndef SLOTTED_ALOHA_METRICS_AGGREGATOR_H
+#define SLOTTED_ALOHA_METRICS_AGGREGATOR_H
+
+#include <stdint.h>
+#include <vector>
+
+#include "ns3/nstime.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/aloha-trace-writer.h"
+
+namespace ns3 {
+
+/*
+ * Computes the metrics plot.py derives from a full trace, one window at a
+ * time, instead of storing the records. Windows are aligned to multiples
+ * of the window length; each is written as one row
+ *
+ *   <start> <throughput> <delay> <fairness> <buffer>
+ *
+ * with the start and the delay in seconds and the throughput in Mbps. The
+ * delay is the mean over nodes of each node's mean delay in the window
+ * (nan when nothing was received), the fairness is Jain's index over the
+ * per-node reception counts, and the buffer is the number of enqueued but
+ * unacknowledged packets averaged over nodes.
+ *
+ * Fairness is taken over the nodes that have had a packet acknowledged so
+ * far, as plot.py takes it over the nodes with any 'r' record. plot.py
+ * sees the whole trace, so the two differ only in windows before a node's
+ * first delivery, where plot.py already counts it as receiving nothing.
+ * The buffer is averaged over the nodes that have traced anything so far.
+ *
+ * Records must arrive in time order, which holds for a single simulation.
+ */
+class AlohaMetricsAggregator : public AlohaTraceWriter {
+
+public:
+
+    AlohaMetricsAggregator(Ptr<OutputStreamWrapper> stream, Time window);
+
+    void Write(const AlohaTraceRecord &record) override;
+    void Close(void) override;
+
+private:
+
+    struct NodeState {
+        bool seen;
+        bool delivered;           /* has had a packet acknowledged */
+        int64_t backlog;          /* enqueued minus acknowledged, cumulative */
+        uint64_t received;        /* in the current window */
+        int64_t delaySum;         /* in the current window, time steps */
+    };
+
+    NodeState &GetNode(uint32_t node);
+    void Flush(void);
+
+    Ptr<OutputStreamWrapper> m_stream;
+    int64_t m_window;             /* time steps */
+    int64_t m_current;            /* index of the open window, -1 before the first record */
+    bool m_closed;
+
+    std::vector<NodeState> m_nodes;
+    std::vector<uint32_t> m_touched;   /* nodes with receptions in the open window */
+    uint32_t m_seen;
+    uint32_t m_delivering;        /* nodes with delivered set */
+    int64_t m_backlog;            /* sum of the nodes' backlogs */
+
+    /* current window */
+    uint64_t m_bytes;
+    uint64_t m_received;
+    uint64_t m_receivedSquares;   /* sum over nodes of received^2 */
+
+}; /* class AlohaMetricsAggregator */
+
+} /* namespace ns3 */
+
+#endif /* SLOTTED_ALOHA_METRICS_AGGREGATOR_H */
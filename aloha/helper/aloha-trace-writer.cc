@@ -0,0 +1,239 @@
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "aloha-trace-writer.h"
+
+#include <algorithm>
+#include <cstring>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AlohaTraceWriter");
+
+/* records written per fwrite */
+static const std::size_t BINARY_BUFFER_RECORDS = 1 << 15;
+
+/* file suffixes and value sizes of AlohaColumnarTraceWriter's columns */
+static const char *const COLUMN_NAMES[] = {"time", "delay", "node", "size", "event"};
+static const uint32_t COLUMN_SIZES[] = {8, 8, 4, 4, 1};
+
+AlohaTraceWriter::~AlohaTraceWriter()
+{
+}
+
+void
+AlohaTraceWriter::Close(void)
+{
+}
+
+AlohaTraceRecord
+AlohaTraceWriter::MakeEnqueue(Time now, uint32_t node)
+{
+    AlohaTraceRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.time = now.GetTimeStep();
+    record.node = node;
+    record.event = AlohaTraceRecord::ENQUEUE;
+    return record;
+}
+
+AlohaTraceRecord
+AlohaTraceWriter::MakeReceive(Time now, uint32_t node, Time delay, uint32_t size)
+{
+    AlohaTraceRecord record;
+    std::memset(&record, 0, sizeof(record));
+    record.time = now.GetTimeStep();
+    record.delay = delay.GetTimeStep();
+    record.node = node;
+    record.size = size;
+    record.event = AlohaTraceRecord::RECEIVE;
+    return record;
+}
+
+AlohaAsciiTraceWriter::AlohaAsciiTraceWriter(Ptr<OutputStreamWrapper> stream)
+    : m_stream(stream)
+{
+    NS_ASSERT(m_stream);
+}
+
+void
+AlohaAsciiTraceWriter::Write(const AlohaTraceRecord &record)
+{
+    // '\n' rather than std::endl: the stream is flushed once, on Close
+    std::ostream &os = *m_stream->GetStream();
+    if (record.event == AlohaTraceRecord::ENQUEUE) {
+        os << "+ " << TimeStep(record.time).GetSeconds() << " " << record.node << " " << '\n';
+    } else {
+        os << "r " << TimeStep(record.time).GetSeconds() << " " << record.node << " "
+           << TimeStep(record.delay).GetSeconds() << " " << record.size << '\n';
+    }
+}
+
+void
+AlohaAsciiTraceWriter::Close(void)
+{
+    m_stream->GetStream()->flush();
+}
+
+AlohaBinaryTraceWriter::AlohaBinaryTraceWriter(std::string filename)
+{
+    m_file = std::fopen(filename.c_str(), "wb");
+    NS_ABORT_MSG_UNLESS(m_file, "Cannot open " << filename);
+    m_buffer.reserve(BINARY_BUFFER_RECORDS);
+
+    char header[HEADER_SIZE];
+    std::memset(header, 0, sizeof(header));
+    uint32_t version = VERSION;
+    uint32_t headerSize = HEADER_SIZE;
+    uint32_t recordSize = sizeof(AlohaTraceRecord);
+    int64_t stepsPerSecond = Seconds(1).GetTimeStep();
+    std::memcpy(header, "ALOHATRC", 8);
+    std::memcpy(header + 8, &version, 4);
+    std::memcpy(header + 12, &headerSize, 4);
+    std::memcpy(header + 16, &recordSize, 4);
+    std::memcpy(header + 24, &stepsPerSecond, 8);
+
+    NS_ABORT_MSG_UNLESS(std::fwrite(header, sizeof(header), 1, m_file) == 1,
+                        "Cannot write the header of " << filename);
+}
+
+AlohaBinaryTraceWriter::~AlohaBinaryTraceWriter()
+{
+    Close();
+}
+
+void
+AlohaBinaryTraceWriter::Write(const AlohaTraceRecord &record)
+{
+    NS_ASSERT_MSG(m_file, "Trace written after Close");
+    m_buffer.push_back(record);
+    if (m_buffer.size() == BINARY_BUFFER_RECORDS) {
+        Drain();
+    }
+}
+
+void
+AlohaBinaryTraceWriter::Drain(void)
+{
+    if (!m_buffer.empty()) {
+        std::size_t written = std::fwrite(m_buffer.data(), sizeof(AlohaTraceRecord), m_buffer.size(), m_file);
+        NS_ABORT_MSG_UNLESS(written == m_buffer.size(), "Short write to the binary trace");
+        m_buffer.clear();
+    }
+}
+
+void
+AlohaBinaryTraceWriter::Close(void)
+{
+    if (m_file) {
+        Drain();
+        std::fclose(m_file);
+        m_file = 0;
+    }
+}
+
+AlohaColumnarTraceWriter::AlohaColumnarTraceWriter(std::string prefix, uint32_t chunkRecords)
+    : m_chunkRecords(chunkRecords),
+      m_count(0),
+      m_closed(false)
+{
+    // keeps every chunk, and so every footer, 8-byte aligned
+    NS_ASSERT_MSG(chunkRecords > 0 && chunkRecords % 8 == 0,
+                  "Columnar chunks must hold a positive multiple of 8 records");
+
+    m_time.resize(chunkRecords);
+    m_delay.resize(chunkRecords);
+    m_node.resize(chunkRecords);
+    m_size.resize(chunkRecords);
+    m_event.resize(chunkRecords);
+
+    for (uint32_t i = 0; i < COLUMNS; i++) {
+        std::string filename = prefix + "." + COLUMN_NAMES[i];
+        m_files[i] = std::fopen(filename.c_str(), "wb");
+        NS_ABORT_MSG_UNLESS(m_files[i], "Cannot open " << filename);
+
+        char header[HEADER_SIZE];
+        std::memset(header, 0, sizeof(header));
+        uint32_t version = VERSION;
+        uint32_t headerSize = HEADER_SIZE;
+        uint32_t valueSize = COLUMN_SIZES[i];
+        int64_t stepsPerSecond = Seconds(1).GetTimeStep();
+        std::memcpy(header, "ALOHACOL", 8);
+        std::memcpy(header + 8, &version, 4);
+        std::memcpy(header + 12, &headerSize, 4);
+        std::memcpy(header + 16, &chunkRecords, 4);
+        std::memcpy(header + 20, &valueSize, 4);
+        std::memcpy(header + 24, &stepsPerSecond, 8);
+
+        NS_ABORT_MSG_UNLESS(std::fwrite(header, sizeof(header), 1, m_files[i]) == 1,
+                            "Cannot write the header of " << filename);
+    }
+}
+
+AlohaColumnarTraceWriter::~AlohaColumnarTraceWriter()
+{
+    Close();
+}
+
+void
+AlohaColumnarTraceWriter::Write(const AlohaTraceRecord &record)
+{
+    NS_ASSERT_MSG(!m_closed, "Trace written after Close");
+    m_time[m_count] = record.time;
+    m_delay[m_count] = record.delay;
+    m_node[m_count] = record.node;
+    m_size[m_count] = record.size;
+    m_event[m_count] = record.event;
+    if (++m_count == m_chunkRecords) {
+        Drain();
+    }
+}
+
+void
+AlohaColumnarTraceWriter::Drain(void)
+{
+    // a short last chunk is zero-padded, so chunks keep a fixed stride
+    for (uint32_t i = m_count; i < m_chunkRecords; i++) {
+        m_time[i] = m_delay[i] = 0;
+        m_node[i] = m_size[i] = 0;
+        m_event[i] = 0;
+    }
+
+    char footer[FOOTER_SIZE];
+    std::memset(footer, 0, sizeof(footer));
+    int64_t minTime = m_time[0];
+    int64_t maxTime = m_time[0];
+    for (uint32_t i = 1; i < m_count; i++) {
+        minTime = std::min(minTime, m_time[i]);
+        maxTime = std::max(maxTime, m_time[i]);
+    }
+    std::memcpy(footer, &m_count, 4);
+    std::memcpy(footer + 8, &minTime, 8);
+    std::memcpy(footer + 16, &maxTime, 8);
+
+    const void *values[COLUMNS] = {m_time.data(), m_delay.data(), m_node.data(),
+                                   m_size.data(), m_event.data()};
+    for (uint32_t i = 0; i < COLUMNS; i++) {
+        std::size_t written = std::fwrite(values[i], COLUMN_SIZES[i], m_chunkRecords, m_files[i]);
+        NS_ABORT_MSG_UNLESS(written == m_chunkRecords && std::fwrite(footer, sizeof(footer), 1, m_files[i]) == 1,
+                            "Short write to the " << COLUMN_NAMES[i] << " column");
+    }
+    m_count = 0;
+}
+
+void
+AlohaColumnarTraceWriter::Close(void)
+{
+    if (m_closed) {
+        return;
+    }
+    m_closed = true;
+
+    if (m_count > 0) {
+        Drain();
+    }
+    for (uint32_t i = 0; i < COLUMNS; i++) {
+        std::fclose(m_files[i]);
+    }
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,174 @@
+#ifndef SLOTTED_ALOHA_TRACE_WRITER_H
+#define SLOTTED_ALOHA_TRACE_WRITER_H
+
+#include <stdint.h>
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "ns3/simple-ref-count.h"
+#include "ns3/nstime.h"
+#include "ns3/output-stream-wrapper.h"
+
+namespace ns3 {
+
+/*
+ * One trace event. This is also the on-disk record of the binary format,
+ * so its layout is fixed at 32 bytes: times are in simulator time steps
+ * and delay and size are only meaningful for receptions.
+ */
+struct AlohaTraceRecord
+{
+    static constexpr uint8_t ENQUEUE = '+';
+    static constexpr uint8_t RECEIVE = 'r';
+
+    int64_t time;
+    int64_t delay;
+    uint32_t node;
+    uint32_t size;
+    uint8_t event;
+    uint8_t padding[7];
+};
+
+static_assert(sizeof(AlohaTraceRecord) == 32, "AlohaTraceRecord is an on-disk layout");
+
+/*
+ * Destination of the records produced by AlohaHelper's trace hooks.
+ */
+class AlohaTraceWriter : public SimpleRefCount<AlohaTraceWriter> {
+
+public:
+
+    virtual ~AlohaTraceWriter();
+
+    virtual void Write(const AlohaTraceRecord &record) = 0;
+
+    /* Writes out anything buffered. Called once the simulation is destroyed;
+     * must tolerate being called more than once. */
+    virtual void Close(void);
+
+    static AlohaTraceRecord MakeEnqueue(Time now, uint32_t node);
+    static AlohaTraceRecord MakeReceive(Time now, uint32_t node, Time delay, uint32_t size);
+
+}; /* class AlohaTraceWriter */
+
+/*
+ * The text format plot.py reads:
+ *   + <time> <node>
+ *   r <time> <node> <delay> <size>
+ * with times in seconds.
+ */
+class AlohaAsciiTraceWriter : public AlohaTraceWriter {
+
+public:
+
+    AlohaAsciiTraceWriter(Ptr<OutputStreamWrapper> stream);
+
+    void Write(const AlohaTraceRecord &record) override;
+    void Close(void) override;
+
+private:
+
+    Ptr<OutputStreamWrapper> m_stream;
+
+}; /* class AlohaAsciiTraceWriter */
+
+/*
+ * Fixed-size records behind a 32-byte header, in host byte order, so a
+ * trace can be memory-mapped as an array of AlohaTraceRecord:
+ *
+ *   char     magic[8]          "ALOHATRC"
+ *   uint32_t version           1
+ *   uint32_t headerSize        32
+ *   uint32_t recordSize        32
+ *   uint32_t reserved
+ *   int64_t  stepsPerSecond    time steps per second
+ */
+class AlohaBinaryTraceWriter : public AlohaTraceWriter {
+
+public:
+
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t HEADER_SIZE = 32;
+
+    AlohaBinaryTraceWriter(std::string filename);
+    ~AlohaBinaryTraceWriter();
+
+    void Write(const AlohaTraceRecord &record) override;
+    void Close(void) override;
+
+private:
+
+    void Drain(void);
+
+    std::FILE *m_file;
+    std::vector<AlohaTraceRecord> m_buffer;
+
+}; /* class AlohaBinaryTraceWriter */
+
+/*
+ * One file per field, <prefix>.time, .delay, .node, .size and .event, so a
+ * reader only decodes the fields it needs. Each file starts with a 32-byte
+ * header, in host byte order:
+ *
+ *   char     magic[8]          "ALOHACOL"
+ *   uint32_t version           1
+ *   uint32_t headerSize        32
+ *   uint32_t chunkRecords      values per chunk
+ *   uint32_t valueSize         8, 8, 4, 4 and 1 bytes respectively
+ *   int64_t  stepsPerSecond    time steps per second
+ *
+ * followed by chunks of chunkRecords values and a 24-byte footer:
+ *
+ *   uint32_t count             values in use; only the last chunk is short
+ *   uint32_t reserved
+ *   int64_t  minTime           time steps
+ *   int64_t  maxTime
+ *
+ * Every chunk has the same size, so chunk k of any column sits at
+ * headerSize + k * (chunkRecords * valueSize + 24), and the footers of the
+ * time column are enough to find the chunks covering a time window.
+ */
+class AlohaColumnarTraceWriter : public AlohaTraceWriter {
+
+public:
+
+    static constexpr uint32_t VERSION = 1;
+    static constexpr uint32_t HEADER_SIZE = 32;
+    static constexpr uint32_t FOOTER_SIZE = 24;
+
+    AlohaColumnarTraceWriter(std::string prefix, uint32_t chunkRecords = 65536);
+    ~AlohaColumnarTraceWriter();
+
+    void Write(const AlohaTraceRecord &record) override;
+    void Close(void) override;
+
+private:
+
+    enum Column {
+        TIME,
+        DELAY,
+        NODE,
+        SIZE,
+        EVENT,
+        COLUMNS
+    };
+
+    void Drain(void);
+
+    std::FILE *m_files[COLUMNS];
+    uint32_t m_chunkRecords;
+    uint32_t m_count;
+    bool m_closed;
+
+    std::vector<int64_t> m_time;
+    std::vector<int64_t> m_delay;
+    std::vector<uint32_t> m_node;
+    std::vector<uint32_t> m_size;
+    std::vector<uint8_t> m_event;
+
+}; /* class AlohaColumnarTraceWriter */
+
+} /* namespace ns3 */
+
+#endif /* SLOTTED_ALOHA_TRACE_WRITER_H */
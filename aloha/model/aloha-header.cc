@@ -43,13 +43,13 @@ AlohaHeader::Print (std::ostream &os) const
 uint32_t
 AlohaHeader::GetSize(void)
 {
-    return 12;
+    return SERIALIZED_SIZE;
 }
 
 uint32_t
 AlohaHeader::GetSerializedSize (void) const
 {
-    return 12;
+    return SERIALIZED_SIZE;
 }
 
 void
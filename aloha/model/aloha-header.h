@@ -13,6 +13,8 @@ class AlohaHeader : public Header {
 
 public:
 
+    static constexpr uint32_t SERIALIZED_SIZE = 12;
+
     AlohaHeader(void);
     AlohaHeader(Address src, Address dst);
     ~AlohaHeader();
@@ -0,0 +1,498 @@
+#include "ns3/log.h"
+#include "ns3/assert.h"
+#include "ns3/abort.h"
+#include "ns3/aloha-kernel.h"
+
+#include <algorithm>
+#include <cmath>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AlohaKernel");
+
+/* ns-3 gives explicitly assigned streams the upper half of the stream space */
+static const uint64_t ASSIGNED_STREAM_BASE = (1ULL << 63);
+
+/* the ACK timer slack AlohaMac adds for propagation */
+static const uint64_t ACK_SLACK_US = 2;
+
+AlohaKernel::Config::Config()
+{
+    sink = 0;
+    range = 100.0;
+    speed = 299792458.0;
+    stepsPerSecond = 1000000000;
+    dataAirtime = 0;
+    ackAirtime = 0;
+    enableCollisions = true;
+    packetSize = 1028;
+    maxPackets = 100;
+    queueSize = 100;
+    interval = stepsPerSecond / 100;
+    startTime = 0;
+    stopTime = 10 * stepsPerSecond;
+    minBackoffExponent = 4;
+    maxBackoffExponent = 8;
+    backoffFactor = 1000;
+    jitter = 1000;
+    usePriorityAck = false;
+    useCarrierSensing = false;
+    slotted = false;
+    slotTime = 0;
+    seed = 1;
+    run = 1;
+    stream = 0;
+}
+
+AlohaKernel::AlohaKernel(const Config &config)
+    : m_config(config)
+{
+    NS_ABORT_MSG_IF(m_config.positions.empty(), "AlohaKernel needs at least one node");
+    NS_ABORT_MSG_UNLESS(m_config.sink < m_config.positions.size(), "The sink is not a node");
+    NS_ABORT_MSG_UNLESS(m_config.dataAirtime > 0 && m_config.ackAirtime > 0, "Airtimes must be set");
+    NS_ABORT_MSG_IF(m_config.slotted && m_config.slotTime <= 0, "Slotted runs need a slot time");
+
+    m_ascii = 0;
+    m_now = 0;
+    m_seq = 0;
+    m_executed = 0;
+    m_enqueued = 0;
+    m_dropped = 0;
+    m_transmissions = 0;
+
+    // Same receivers, in the same (attach) order, as WirelessChannel's
+    // stationary path.
+    uint32_t n = m_config.positions.size();
+    m_stations.resize(n);
+    for (uint32_t i = 0; i < n; i++) {
+        for (uint32_t j = 0; j < n; j++) {
+            if (i == j) {
+                continue;
+            }
+            const Vector &a = m_config.positions[i];
+            const Vector &b = m_config.positions[j];
+            double distance = std::sqrt((a.x - b.x) * (a.x - b.x) + (a.y - b.y) * (a.y - b.y)
+                                        + (a.z - b.z) * (a.z - b.z));
+            if (distance <= m_config.range) {
+                int64_t delay = std::llround(distance / m_config.speed * m_config.stepsPerSecond);
+                m_stations[i].links.push_back(Link {j, delay});
+            }
+        }
+    }
+}
+
+AlohaKernel::~AlohaKernel()
+{
+}
+
+void
+AlohaKernel::EnableAscii(std::ostream *os)
+{
+    m_ascii = os;
+}
+
+void
+AlohaKernel::SetRun(uint64_t run)
+{
+    m_config.run = run;
+}
+
+int64_t
+AlohaKernel::FromMicroSeconds(uint64_t us) const
+{
+    return us * m_config.stepsPerSecond / 1000000;
+}
+
+double
+AlohaKernel::ToSeconds(int64_t time) const
+{
+    return time / double(m_config.stepsPerSecond);
+}
+
+void
+AlohaKernel::Schedule(int64_t delay, uint32_t type, uint32_t node, uint32_t arg, uint32_t handle)
+{
+    NS_ASSERT(delay >= 0);
+    m_events.push_back(Event {m_now + delay, m_seq++, type, node, arg, handle});
+    std::push_heap(m_events.begin(), m_events.end(),
+        [](const Event &a, const Event &b) {
+            return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+        });
+}
+
+void
+AlohaKernel::Run(void)
+{
+    uint32_t n = m_stations.size();
+
+    m_events.clear();
+    m_frames.clear();
+    m_freeFrames.clear();
+    m_deliveries.clear();
+    m_now = 0;
+    m_seq = 0;
+    m_executed = 0;
+    m_enqueued = 0;
+    m_dropped = 0;
+    m_transmissions = 0;
+
+    m_rngs.clear();
+    m_rngs.reserve(n);
+    for (uint32_t i = 0; i < n; i++) {
+        // AlohaNetDevice::AssignStreams hands out one MAC and one PHY stream
+        m_rngs.emplace_back(m_config.seed, ASSIGNED_STREAM_BASE + m_config.stream + 2 * i, m_config.run);
+
+        Station &s = m_stations[i];
+        s.sent = 0;
+        s.queue.clear();
+        s.exponent = m_config.minBackoffExponent;
+        s.txRunning = false;
+        s.txAt = 0;
+        s.txGeneration = 0;
+        s.ackRunning = false;
+        s.ackGeneration = 0;
+        s.state = IDLE;
+        s.receiving = 0;
+        s.epoch = 0;
+        s.units.clear();
+        s.free.clear();
+    }
+
+    // the sink's own client echoes over loopback and never reaches the MAC
+    for (uint32_t i = 0; i < n; i++) {
+        if (i != m_config.sink) {
+            Schedule(m_config.startTime, APP_START, i);
+        }
+    }
+
+    auto later = [](const Event &a, const Event &b) {
+        return a.time > b.time || (a.time == b.time && a.seq > b.seq);
+    };
+
+    while (!m_events.empty() && m_events.front().time < m_config.stopTime) {
+        std::pop_heap(m_events.begin(), m_events.end(), later);
+        Event event = m_events.back();
+        m_events.pop_back();
+
+        m_now = event.time;
+        m_executed++;
+        Dispatch(event);
+    }
+
+    NS_LOG_INFO("Executed " << m_executed << " events: " << m_enqueued << " enqueued, "
+                << m_transmissions << " transmissions, " << m_deliveries.size() << " deliveries");
+}
+
+void
+AlohaKernel::Dispatch(const Event &event)
+{
+    Station &s = m_stations[event.node];
+
+    switch (event.type) {
+    case APP_START:
+        Schedule(0, APP_SEND, event.node);
+        break;
+    case APP_SEND:
+        AppSend(event.node);
+        break;
+    case TX_TIMER:
+        if (s.txRunning && s.txGeneration == event.arg) {
+            s.txRunning = false;
+            MacTransmit(event.node);
+        }
+        break;
+    case ACK_TIMER:
+        if (s.ackRunning && s.ackGeneration == event.arg) {
+            s.ackRunning = false;
+            MacAckTimeout(event.node);
+        }
+        break;
+    case START_TX:
+        s.state = TX;
+        if (m_config.enableCollisions && s.receiving > 0) {
+            s.epoch++;
+        }
+        break;
+    case FINISH_TX:
+        s.state = (s.receiving > 0) ? RX : IDLE;
+        ReleaseFrame(event.arg);
+        break;
+    case START_RX:
+        StartReceive(event.node, event.arg, event.handle);
+        break;
+    case FINISH_RX:
+        FinishReceive(event.node, event.arg, event.handle);
+        break;
+    default:
+        NS_FATAL_ERROR("Unknown event type " << event.type);
+    }
+}
+
+void
+AlohaKernel::AppSend(uint32_t node)
+{
+    Station &s = m_stations[node];
+    MacSend(node);
+
+    s.sent++;
+    if (m_config.maxPackets == 0 || s.sent < m_config.maxPackets) {
+        Schedule(m_config.interval, APP_SEND, node);
+    }
+}
+
+uint32_t
+AlohaKernel::GetInteger(uint32_t node, uint32_t min, uint32_t max)
+{
+    // UniformRandomVariable::GetInteger
+    double v = min + m_rngs[node].RandU01() * ((double) max + 1.0 - min);
+    return static_cast<uint32_t>(v);
+}
+
+int64_t
+AlohaKernel::GetBackoffDelay(uint32_t node)
+{
+    uint32_t backoff = GetInteger(node, 0, 1u << m_stations[node].exponent);
+    if (m_config.slotted) {
+        return m_config.slotTime * backoff;
+    }
+    return FromMicroSeconds(uint64_t(backoff) * m_config.backoffFactor);
+}
+
+void
+AlohaKernel::ScheduleTransmission(uint32_t node, int64_t delay)
+{
+    Station &s = m_stations[node];
+
+    if (m_config.slotted) {
+        int64_t at = m_now + delay;
+        int64_t offset = at % m_config.slotTime;
+        if (offset != 0) {
+            at += m_config.slotTime - offset;
+        }
+        delay = at - m_now;
+    }
+
+    s.txRunning = true;
+    s.txAt = m_now + delay;
+    Schedule(delay, TX_TIMER, node, ++s.txGeneration);
+}
+
+void
+AlohaKernel::MacSend(uint32_t node)
+{
+    Station &s = m_stations[node];
+
+    if (s.queue.empty()) {
+        int64_t delay = GetBackoffDelay(node);
+        int64_t jitter = FromMicroSeconds(GetInteger(node, 0, m_config.jitter));
+        ScheduleTransmission(node, delay + jitter);
+    }
+
+    m_enqueued++;
+    if (m_ascii) {
+        *m_ascii << "+ " << ToSeconds(m_now) << " " << node << " " << '\n';
+    }
+
+    if (s.queue.size() < m_config.queueSize) {
+        s.queue.push_back(m_now);
+    } else {
+        m_dropped++;
+    }
+}
+
+void
+AlohaKernel::MacTransmit(uint32_t node)
+{
+    Station &s = m_stations[node];
+
+    if (m_config.useCarrierSensing && s.state == RX) {
+        StartBackoff(node);
+        return;
+    }
+
+    NS_ASSERT(!s.queue.empty());
+    m_transmissions++;
+
+    uint32_t frame = AllocateFrame();
+    m_frames[frame] = Frame {node, m_config.sink, false, s.queue.front(), m_config.dataAirtime, 0};
+    PhySend(node, frame);
+
+    s.ackRunning = true;
+    Schedule(m_config.dataAirtime + m_config.ackAirtime + FromMicroSeconds(ACK_SLACK_US),
+             ACK_TIMER, node, ++s.ackGeneration);
+}
+
+void
+AlohaKernel::MacReceive(uint32_t node, const Frame &frame)
+{
+    Station &s = m_stations[node];
+    bool isAck = (frame.sender == m_config.sink);
+
+    if (node == m_config.sink) {
+        uint32_t ack = AllocateFrame();
+        m_frames[ack] = Frame {node, frame.sender, true, frame.enqueued, m_config.ackAirtime, 0};
+        PhySend(node, ack);
+    } else if (node == frame.destination) {
+        Delivery delivery = {m_now, node, m_now - frame.enqueued, m_config.packetSize};
+        m_deliveries.push_back(delivery);
+        if (m_ascii) {
+            *m_ascii << "r " << ToSeconds(m_now) << " " << node << " " << ToSeconds(delivery.delay)
+                     << " " << delivery.size << '\n';
+        }
+
+        s.ackRunning = false;
+        s.exponent = m_config.minBackoffExponent;
+        if (!s.queue.empty()) {
+            s.queue.pop_front();
+        }
+        // (AlohaMac would abort on a stale ACK with a transmission pending)
+        if (!s.queue.empty() && !s.txRunning) {
+            ScheduleTransmission(node, GetBackoffDelay(node));
+        }
+    } else if (m_config.usePriorityAck && !isAck && !m_config.slotted) {
+        if (s.txRunning) {
+            int64_t left = s.txAt - m_now;
+            s.txAt = m_now + left + m_config.ackAirtime + FromMicroSeconds(ACK_SLACK_US);
+            Schedule(s.txAt - m_now, TX_TIMER, node, ++s.txGeneration);
+        }
+    }
+}
+
+void
+AlohaKernel::MacAckTimeout(uint32_t node)
+{
+    StartBackoff(node);
+}
+
+void
+AlohaKernel::StartBackoff(uint32_t node)
+{
+    Station &s = m_stations[node];
+    s.exponent = std::min(s.exponent + 1, m_config.maxBackoffExponent);
+    ScheduleTransmission(node, GetBackoffDelay(node));
+}
+
+uint32_t
+AlohaKernel::AllocateFrame(void)
+{
+    if (!m_freeFrames.empty()) {
+        uint32_t frame = m_freeFrames.back();
+        m_freeFrames.pop_back();
+        return frame;
+    }
+    m_frames.emplace_back();
+    return m_frames.size() - 1;
+}
+
+void
+AlohaKernel::ReleaseFrame(uint32_t frame)
+{
+    NS_ASSERT(m_frames[frame].refs > 0);
+    if (--m_frames[frame].refs == 0) {
+        m_freeFrames.push_back(frame);
+    }
+}
+
+uint32_t
+AlohaKernel::Reserve(uint32_t node)
+{
+    Station &s = m_stations[node];
+    if (!s.free.empty()) {
+        uint32_t handle = s.free.back();
+        s.free.pop_back();
+        return handle;
+    }
+    s.units.emplace_back();
+    return s.units.size() - 1;
+}
+
+void
+AlohaKernel::PhySend(uint32_t node, uint32_t frame)
+{
+    // Receptions first, then the sender's own start and finish, as
+    // WirelessChannel::Send schedules them.
+    const std::vector<Link> &links = m_stations[node].links;
+    int64_t duration = m_frames[frame].duration;
+    m_frames[frame].refs = links.size() + 1;
+
+    for (const Link &link : links) {
+        uint32_t handle = Reserve(link.receiver);
+        Schedule(link.delay, START_RX, link.receiver, frame, handle);
+        Schedule(link.delay + duration, FINISH_RX, link.receiver, frame, handle);
+    }
+
+    Schedule(0, START_TX, node, frame);
+    Schedule(duration, FINISH_TX, node, frame);
+}
+
+void
+AlohaKernel::StartReceive(uint32_t node, uint32_t frame, uint32_t handle)
+{
+    Station &s = m_stations[node];
+
+    bool collision = m_config.enableCollisions && (s.receiving > 0 || s.state == TX);
+    if (collision) {
+        s.epoch++;
+    }
+
+    s.units[handle] = Unit {frame, s.epoch, collision};
+    s.receiving++;
+
+    if (s.state == IDLE) {
+        s.state = RX;
+    }
+}
+
+void
+AlohaKernel::FinishReceive(uint32_t node, uint32_t frame, uint32_t handle)
+{
+    Station &s = m_stations[node];
+    NS_ASSERT(s.units[handle].frame == frame);
+
+    bool corrupted = s.units[handle].corrupted || s.units[handle].epoch != s.epoch;
+    s.free.push_back(handle);
+    s.receiving--;
+
+    if (!m_config.enableCollisions || !corrupted) {
+        // copied, since the MAC may allocate (and so move) frames
+        Frame received = m_frames[frame];
+        MacReceive(node, received);
+    }
+
+    if (s.receiving == 0 && s.state == RX) {
+        s.state = IDLE;
+    }
+    ReleaseFrame(frame);
+}
+
+const std::vector<AlohaKernel::Delivery> &
+AlohaKernel::GetDeliveries(void) const
+{
+    return m_deliveries;
+}
+
+uint64_t
+AlohaKernel::GetEnqueued(void) const
+{
+    return m_enqueued;
+}
+
+uint64_t
+AlohaKernel::GetDropped(void) const
+{
+    return m_dropped;
+}
+
+uint64_t
+AlohaKernel::GetTransmissions(void) const
+{
+    return m_transmissions;
+}
+
+uint64_t
+AlohaKernel::GetEvents(void) const
+{
+    return m_executed;
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,219 @@
+#ifndef SLOTTED_ALOHA_KERNEL_H
+#define SLOTTED_ALOHA_KERNEL_H
+
+#include <stdint.h>
+#include <deque>
+#include <ostream>
+#include <vector>
+
+#include "ns3/vector.h"
+#include "ns3/rng-stream.h"
+
+namespace ns3 {
+
+/*
+ * Standalone re-implementation of an aloha.py run: UdpEchoClient-like
+ * sources over AlohaMac, WirelessPhy and a stationary WirelessChannel, with
+ * no Objects, Ptrs, attributes, packets or internet stack.
+ *
+ * Stations, frames and reception slots are plain structs, and events live
+ * in a binary heap ordered by (time, insertion order) like ns-3's own
+ * scheduler. The events of a run are scheduled in the order the modules
+ * schedule them and every MAC draws from the RngStream that
+ * AlohaHelper::AssignStreams would give its device, so a run follows the
+ * ns-3 model closely; ties between simultaneous events of different layers
+ * can still resolve differently, so results are meant to be compared as
+ * distributions.
+ *
+ * Not modelled: the PHY error model, receiver pruning (which does not
+ * change outcomes) and mobility. All times are in time steps of
+ * Config::stepsPerSecond.
+ */
+class AlohaKernel {
+
+public:
+
+    struct Config
+    {
+        Config();
+
+        std::vector<Vector> positions;  /* one per node, in node id order */
+        uint32_t sink;                  /* node id of the sink */
+        double range;                   /* WirelessChannel::TransmissionRange */
+        double speed;                   /* propagation speed, m/s */
+
+        int64_t stepsPerSecond;
+        int64_t dataAirtime;            /* WirelessPhy::GetTransmissionTime of a data frame */
+        int64_t ackAirtime;             /* ... and of an ACK */
+        bool enableCollisions;
+
+        uint32_t packetSize;            /* MAC payload bytes per data frame */
+        uint32_t maxPackets;            /* per source, 0 for no limit */
+        uint32_t queueSize;             /* MAC queue limit in packets */
+        int64_t interval;
+        int64_t startTime;
+        int64_t stopTime;
+
+        uint32_t minBackoffExponent;
+        uint32_t maxBackoffExponent;
+        uint32_t backoffFactor;         /* microseconds */
+        uint32_t jitter;                /* microseconds */
+        bool usePriorityAck;
+        bool useCarrierSensing;
+        bool slotted;
+        int64_t slotTime;
+
+        uint32_t seed;                  /* RngSeedManager seed and run */
+        uint64_t run;
+        int64_t stream;                 /* first stream passed to AssignStreams */
+    };
+
+    struct Delivery
+    {
+        int64_t time;
+        uint32_t node;
+        int64_t delay;
+        uint32_t size;
+    };
+
+    AlohaKernel(const Config &config);
+    ~AlohaKernel();
+
+    /* Writes the same '+' and 'r' records as AlohaHelper's ascii trace. */
+    void EnableAscii(std::ostream *os);
+
+    /* Runs from time zero to stopTime; may be called again after SetRun. */
+    void Run(void);
+    void SetRun(uint64_t run);
+
+    const std::vector<Delivery> &GetDeliveries(void) const;
+    uint64_t GetEnqueued(void) const;
+    uint64_t GetDropped(void) const;
+    uint64_t GetTransmissions(void) const;
+    uint64_t GetEvents(void) const;
+
+private:
+
+    enum EventType {
+        APP_START,
+        APP_SEND,
+        TX_TIMER,
+        ACK_TIMER,
+        START_TX,
+        FINISH_TX,
+        START_RX,
+        FINISH_RX
+    };
+
+    enum PhyState {
+        RX,
+        TX,
+        IDLE
+    };
+
+    struct Event
+    {
+        int64_t time;
+        uint64_t seq;
+        uint32_t type;
+        uint32_t node;
+        uint32_t arg;                   /* frame, or timer generation */
+        uint32_t handle;                /* reception slot */
+    };
+
+    struct Frame
+    {
+        uint32_t sender;
+        uint32_t destination;
+        bool ack;
+        int64_t enqueued;               /* of the data packet it carries or acknowledges */
+        int64_t duration;
+        uint32_t refs;
+    };
+
+    struct Unit
+    {
+        uint32_t frame;
+        uint64_t epoch;
+        bool corrupted;
+    };
+
+    struct Link
+    {
+        uint32_t receiver;
+        int64_t delay;
+    };
+
+    struct Station
+    {
+        /* source */
+        uint32_t sent;
+
+        /* MAC */
+        std::deque<int64_t> queue;
+        uint32_t exponent;
+        bool txRunning;
+        int64_t txAt;
+        uint32_t txGeneration;
+        bool ackRunning;
+        uint32_t ackGeneration;
+
+        /* PHY */
+        PhyState state;
+        uint32_t receiving;
+        uint64_t epoch;
+        std::vector<Unit> units;
+        std::vector<uint32_t> free;
+
+        /* channel */
+        std::vector<Link> links;
+    };
+
+    void Schedule(int64_t delay, uint32_t type, uint32_t node, uint32_t arg = 0, uint32_t handle = 0);
+    void Dispatch(const Event &event);
+
+    /* UdpEchoClient */
+    void AppSend(uint32_t node);
+
+    /* AlohaMac */
+    void MacSend(uint32_t node);
+    void MacTransmit(uint32_t node);
+    void MacReceive(uint32_t node, const Frame &frame);
+    void MacAckTimeout(uint32_t node);
+    void StartBackoff(uint32_t node);
+    int64_t GetBackoffDelay(uint32_t node);
+    void ScheduleTransmission(uint32_t node, int64_t delay);
+    uint32_t GetInteger(uint32_t node, uint32_t min, uint32_t max);
+
+    /* WirelessPhy and WirelessChannel */
+    void PhySend(uint32_t node, uint32_t frame);
+    void StartReceive(uint32_t node, uint32_t frame, uint32_t handle);
+    void FinishReceive(uint32_t node, uint32_t frame, uint32_t handle);
+    uint32_t Reserve(uint32_t node);
+    uint32_t AllocateFrame(void);
+    void ReleaseFrame(uint32_t frame);
+
+    int64_t FromMicroSeconds(uint64_t us) const;
+    double ToSeconds(int64_t time) const;
+
+    Config m_config;
+    std::vector<Station> m_stations;
+    std::vector<RngStream> m_rngs;
+    std::vector<Frame> m_frames;
+    std::vector<uint32_t> m_freeFrames;
+    std::vector<Event> m_events;
+    std::vector<Delivery> m_deliveries;
+    std::ostream *m_ascii;
+
+    int64_t m_now;
+    uint64_t m_seq;
+    uint64_t m_executed;
+    uint64_t m_enqueued;
+    uint64_t m_dropped;
+    uint64_t m_transmissions;
+
+}; /* class AlohaKernel */
+
+} /* namespace ns3 */
+
+#endif /* SLOTTED_ALOHA_KERNEL_H */
@@ -13,6 +13,7 @@
 #include "ns3/string.h"
 #include "ns3/pointer.h"
 #include "ns3/boolean.h"
+#include "ns3/nstime.h"
 #include "ns3/aloha-mac.h"
 #include "ns3/aloha-header.h"
 #include "ns3/wireless-mac-upcalls.h"
@@ -34,6 +35,10 @@ AlohaMac::GetTypeId (void)
                             "Trace fired when a packet is attempted to be enqueued at the node",
                             MakeTraceSourceAccessor(&AlohaMac::m_enqueueTrace),
                             "ns3::Packet::TracedCallback")
+            .AddTraceSource("Drop",
+                            "Trace fired when an enqueued packet is dropped because the TX queue is full",
+                            MakeTraceSourceAccessor(&AlohaMac::m_dropTrace),
+                            "ns3::Packet::TracedCallback")
             .AddTraceSource("MacTx",
                             "Trace source indicating a packet has been transmited",
                             MakeTraceSourceAccessor(&AlohaMac::m_macTxTrace),
@@ -45,18 +50,32 @@ AlohaMac::GetTypeId (void)
             .AddAttribute ("UsePriorityAck",
                     "Whether priority ACKs are used",
                     BooleanValue (false),
-                    MakeBooleanAccessor(&AlohaMac::m_usePriorityAcks),
+                    MakeBooleanAccessor(&AlohaMac::SetUsePriorityAck,
+                                        &AlohaMac::GetUsePriorityAck),
                     MakeBooleanChecker ())
             .AddAttribute ("UseCarrierSensing",
                     "Whether carrier sensing is used",
                     BooleanValue (false),
-                    MakeBooleanAccessor(&AlohaMac::m_useCarrierSensing),
+                    MakeBooleanAccessor(&AlohaMac::SetUseCarrierSensing,
+                                        &AlohaMac::GetUseCarrierSensing),
                     MakeBooleanChecker ())
             .AddAttribute ("BackoffFactor",
                     "Scale factor of the backoff window (in microseconds)",
                     UintegerValue(1000),
                     MakeUintegerAccessor(&AlohaMac::m_factor),
                     MakeUintegerChecker<uint32_t>())
+            .AddAttribute ("Slotted",
+                    "Whether data frames start only on slot boundaries. A slot fits "
+                    "a frame of the device MTU, its ACK and SlotGuard; backoffs are "
+                    "counted in slots",
+                    BooleanValue (false),
+                    MakeBooleanAccessor(&AlohaMac::m_slotted),
+                    MakeBooleanChecker ())
+            .AddAttribute ("SlotGuard",
+                    "Idle time at the end of each slot to absorb propagation delay",
+                    TimeValue (MicroSeconds(2)),
+                    MakeTimeAccessor(&AlohaMac::m_slotGuard),
+                    MakeTimeChecker ())
             .AddAttribute ("Jitter",
                     "[0, m_jitter] microsecond jitter after enqueueing a packet in an empty TX queue",
                     UintegerValue(1000),
@@ -78,12 +97,7 @@ AlohaMac::AlohaMac()
      * 
      */
 
-    m_macUpcalls = Create<WirelessMacUpcalls>(
-        MakeCallback (&AlohaMac::Receive, this),
-        MakeCallback (&AlohaMac::StartCarrierSense, this),
-        MakeCallback (&AlohaMac::EndCarrierSense, this),
-        MakeCallback (&AlohaMac::FinishTransmit, this)
-        );
+    m_macUpcalls = Create< WirelessMacUpcallsImpl<AlohaMac> >(this);
 
     /* 
      * DropTailQueues will throw away any packets 
@@ -92,6 +106,7 @@ AlohaMac::AlohaMac()
      */
 
     m_packetQueue = Create<DropTailQueue<Packet>>();
+    m_maxPayloadSize = 1500;
     m_rand = CreateObject<UniformRandomVariable>();
 
     m_transmissionTimer = Timer(Timer::CANCEL_ON_DESTROY);
@@ -106,12 +121,15 @@ AlohaMac::DoDispose()
 {
     m_rand = 0;
     m_packetQueue = 0;
+    m_frame = 0;
+    m_phyFrame = 0;
 }
 
 void
 AlohaMac::SetAddress(Address address)
 {
     m_macAddress = Mac48Address::ConvertFrom(address);    
+    UpdateReceiveFilter();
 }
 
 Address
@@ -125,6 +143,19 @@ AlohaMac::SetPhy(Ptr<WirelessPhy> phy)
 {
     m_phy = phy;
     m_phy->SetMacUpcalls(m_macUpcalls);
+    UpdateReceiveFilter();
+}
+
+void
+AlohaMac::UpdateReceiveFilter(void)
+{
+    if (!m_phy) {
+        return;
+    }
+
+    // Frames addressed to someone else only matter to a node that senses
+    // the carrier or defers on overheard data frames.
+    m_phy->SetReceiveFilter(m_macAddress, m_useCarrierSensing || m_usePriorityAcks);
 }
 
 Ptr<WirelessPhy>
@@ -149,16 +180,22 @@ AlohaMac::Transmit(void)
     }
     
     NS_ASSERT(m_packetQueue->IsEmpty() == false);
-    auto packet = m_packetQueue->Peek()->Copy();
-    AlohaHeader header (m_macAddress, m_sinkAddress);
-    packet->AddHeader(header);
+    if (!m_frame) {
+        m_frame = m_packetQueue->Peek()->Copy();
+        AlohaHeader header (m_macAddress, m_sinkAddress);
+        m_frame->AddHeader(header);
+        m_phyFrame = m_phy->Encapsulate(m_frame);
+    }
+    Ptr<const Packet> packet = m_frame;
 
     NS_LOG_INFO("sending data " << packet << " to PHY");
     m_macTxTrace(packet);
-    m_phy->Send(packet);
+    m_phy->SendFrame(m_phyFrame, m_sinkAddress);
 
-    NS_LOG_INFO("Starting ACK timer for reception at " << (Simulator::Now() + m_phy->GetTransmissionTime(packet) + GetAckTime() + MicroSeconds(2)).GetSeconds() << " (packet time = " << m_phy->GetTransmissionTime(packet) << ", ack time = " << GetAckTime() << ", prop delays=" << MicroSeconds(2) << ")");
-    m_ackTimer.Schedule (m_phy->GetTransmissionTime(packet) + GetAckTime() + MicroSeconds(2));
+    Time packetTime = m_phy->GetTransmissionTime(packet->GetSize());
+    Time ackTime = GetAckTime();
+    NS_LOG_INFO("Starting ACK timer for reception at " << (Simulator::Now() + packetTime + ackTime + MicroSeconds(2)).GetSeconds() << " (packet time = " << packetTime << ", ack time = " << ackTime << ", prop delays=" << MicroSeconds(2) << ")");
+    m_ackTimer.Schedule (packetTime + ackTime + MicroSeconds(2));
 }
 
 bool 
@@ -171,16 +208,19 @@ AlohaMac::Send(Ptr<Packet> packet)
         NS_ASSERT(m_transmissionTimer.IsExpired());
         NS_ASSERT(m_ackTimer.IsExpired());
         // Start the transmission timer if we now have data to send
-        Time delay = MicroSeconds(m_rand->GetInteger(0, std::pow(2, m_backoffExponent))  * m_factor);
+        Time delay = GetBackoffDelay();
         Time jitter = MicroSeconds(m_rand->GetInteger(0, m_jitter));
         
-        m_transmissionTimer.Schedule(delay + jitter);
-        NS_LOG_INFO("Arrival in empty tx queue. Scheduling transmission for " << delay + jitter + Simulator::Now());
+        delay = ScheduleTransmission(delay + jitter);
+        NS_LOG_INFO("Arrival in empty tx queue. Scheduling transmission for " << delay + Simulator::Now());
     }
 
     m_enqueueTrace(packet);
-    return m_packetQueue->Enqueue(packet);
-    
+    if (!m_packetQueue->Enqueue(packet)) {
+        m_dropTrace(packet);
+        return false;
+    }
+    return true;
 }
 
 void
@@ -206,15 +246,18 @@ AlohaMac::Receive(Ptr<Packet> packet)
         m_backoffExponent = m_minBackoffExponent;
 
         auto packet = m_packetQueue->Dequeue();
+        m_frame = 0;
+        m_phyFrame = 0;
         // schedule next transmission if we have more data to send
         if (!m_packetQueue->IsEmpty()) {
-            Time delay = MicroSeconds(m_rand->GetInteger(0, std::pow(2, m_backoffExponent))  * m_factor);
-            m_transmissionTimer.Schedule(delay);
+            ScheduleTransmission(GetBackoffDelay());
         }
          m_netDeviceReceive(packet, header.GetSrc());
     
     
-    } else if (m_usePriorityAcks && !isAck) {
+    } else if (m_usePriorityAcks && !isAck && !m_slotted) {
+        // (a slot already leaves room for the ACK, so slotted stations
+        // have nothing to defer)
         if (m_transmissionTimer.IsRunning()) {
             Time currentDelay = m_transmissionTimer.GetDelayLeft();
             m_transmissionTimer.Cancel();
@@ -236,7 +279,7 @@ AlohaMac::TransmitAck(Ptr<const Packet> p, Mac48Address dst)
     packet->AddPacketTag(tag);
     
     NS_LOG_INFO("sending ACK " << packet << " to PHY");
-    m_phy->Send(packet);
+    m_phy->Send(packet, dst);
 }
 
 void
@@ -248,8 +291,7 @@ AlohaMac::StartBackoff(void)
     NS_ASSERT(m_transmissionTimer.IsRunning() == false);
     NS_ASSERT(m_ackTimer.IsRunning() == false);
     m_backoffExponent = std::min( (++m_backoffExponent) , m_maxBackoffExponent);
-    Time delay = MicroSeconds(m_rand->GetInteger(0, std::pow(2, m_backoffExponent))  * m_factor);
-    m_transmissionTimer.Schedule(delay);
+    Time delay = ScheduleTransmission(GetBackoffDelay());
     NS_LOG_INFO("Next transmission at " << Simulator::Now() + delay << ". (backoff exp = " << m_backoffExponent << ")");
 }
 
@@ -260,13 +302,51 @@ AlohaMac::AckTimeout(void)
     StartBackoff();
 }
 
+Time
+AlohaMac::GetBackoffDelay(void)
+{
+    uint32_t backoff = m_rand->GetInteger(0, std::pow(2, m_backoffExponent));
+    if (m_slotted) {
+        return TimeStep(GetSlotTime().GetTimeStep() * backoff);
+    }
+    return MicroSeconds(backoff * m_factor);
+}
+
+Time
+AlohaMac::GetSlotTime(void) const
+{
+    Time frameTime = m_phy->GetTransmissionTime(m_maxPayloadSize + AlohaHeader::SERIALIZED_SIZE);
+    return frameTime + GetAckTime() + m_slotGuard;
+}
+
+Time
+AlohaMac::ScheduleTransmission(Time delay)
+{
+    if (m_slotted) {
+        // round up to the next boundary of the global slot grid
+        int64_t slot = GetSlotTime().GetTimeStep();
+        int64_t at = (Simulator::Now() + delay).GetTimeStep();
+        int64_t offset = at % slot;
+        if (offset != 0) {
+            at += slot - offset;
+        }
+        delay = TimeStep(at) - Simulator::Now();
+    }
+
+    m_transmissionTimer.Schedule(delay);
+    return delay;
+}
+
+void
+AlohaMac::SetMaxPayloadSize(uint32_t size)
+{
+    m_maxPayloadSize = size;
+}
+
 Time
 AlohaMac::GetAckTime(void) const
 {
-    Ptr<Packet> ack = Create<Packet>();
-    AlohaHeader header;
-    ack->AddHeader(header);
-    return m_phy->GetTransmissionTime(ack);
+    return m_phy->GetTransmissionTime(AlohaHeader::SERIALIZED_SIZE);
 
 }
 void
@@ -319,10 +399,78 @@ AlohaMac::SetMaxBackoffExponent(uint32_t maxBackoffExp)
     m_maxBackoffExponent = maxBackoffExp;
 }
 
+void
+AlohaMac::SetUsePriorityAck(bool usePriorityAck)
+{
+    m_usePriorityAcks = usePriorityAck;
+    UpdateReceiveFilter();
+}
+
+bool
+AlohaMac::GetUsePriorityAck(void) const
+{
+    return m_usePriorityAcks;
+}
+
+void
+AlohaMac::SetUseCarrierSensing(bool useCarrierSensing)
+{
+    m_useCarrierSensing = useCarrierSensing;
+    UpdateReceiveFilter();
+}
+
+bool
+AlohaMac::GetUseCarrierSensing(void) const
+{
+    return m_useCarrierSensing;
+}
+
 void 
 AlohaMac::SetSinkAddress(Mac48Address sinkAddress)
 {
     m_sinkAddress = sinkAddress;
 }
 
+uint32_t
+AlohaMac::GetMinBackoffExponent(void) const
+{
+    return m_minBackoffExponent;
+}
+
+uint32_t
+AlohaMac::GetMaxBackoffExponent(void) const
+{
+    return m_maxBackoffExponent;
+}
+
+uint32_t
+AlohaMac::GetJitter(void) const
+{
+    return m_jitter;
+}
+
+Mac48Address
+AlohaMac::GetSinkAddress(void) const
+{
+    return m_sinkAddress;
+}
+
+bool
+AlohaMac::IsSlotted(void) const
+{
+    return m_slotted;
+}
+
+uint32_t
+AlohaMac::GetQueueCapacity(void) const
+{
+    return m_packetQueue->GetMaxSize().GetValue();
+}
+
+Ptr<Queue<Packet>>
+AlohaMac::GetQueue(void) const
+{
+    return m_packetQueue;
+}
+
 } /* namespace ns3 */
\ No newline at end of file
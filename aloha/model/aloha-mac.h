@@ -122,10 +122,28 @@ public:
     void SetMinBackoffExponent (uint32_t minBackoffExp);  
     void SetMaxBackoffExponent (uint32_t maxBackoffExp);  
     void SetSinkAddress (Mac48Address sinkAddress);
+    void SetMaxPayloadSize (uint32_t size);
+
+    /* Attribute Getters */
+    uint32_t GetMinBackoffExponent (void) const;
+    uint32_t GetMaxBackoffExponent (void) const;
+    uint32_t GetJitter (void) const;
+    Mac48Address GetSinkAddress (void) const;
+    bool IsSlotted (void) const;
+    uint32_t GetQueueCapacity (void) const;
+    Ptr<Queue<Packet>> GetQueue (void) const;
+
+    Time GetAckTime(void) const;
+    Time GetSlotTime(void) const;
+    void SetUsePriorityAck (bool usePriorityAck);
+    bool GetUsePriorityAck (void) const;
+    void SetUseCarrierSensing (bool useCarrierSensing);
+    bool GetUseCarrierSensing (void) const;
     
 protected:
 
     /* PHY Upcalls */
+    friend class WirelessMacUpcallsImpl<AlohaMac>;
     void StartCarrierSense(void);
     void EndCarrierSense(void);
     void FinishTransmit(void);
@@ -138,7 +156,14 @@ protected:
 
 private:
 
-    Time GetAckTime(void) const;
+    Time GetBackoffDelay(void);
+
+    /*
+     * Starts the transmission timer, moving the expiry up to the next slot
+     * boundary when slotted. Returns the delay actually used.
+     */
+    Time ScheduleTransmission(Time delay);
+    void UpdateReceiveFilter(void);
 
     NetDeviceReceiveCallback m_netDeviceReceive;
     Mac48Address m_macAddress;
@@ -147,6 +172,14 @@ private:
     Ptr<WirelessMacUpcalls> m_macUpcalls;
     Ptr<DropTailQueue<Packet>> m_packetQueue;
 
+    /*
+     * The head-of-line packet with the MAC header added, and the same
+     * frame with the PLCP header as well, kept for retries until the
+     * packet leaves the queue.
+     */
+    Ptr<Packet> m_frame;
+    Ptr<Packet> m_phyFrame;
+
     uint32_t m_jitter;
     uint32_t m_factor;
     uint32_t m_backoffExponent;
@@ -159,10 +192,14 @@ private:
 
     TracedCallback<Ptr<ns3::Packet const>> m_enqueueTrace;
     TracedCallback<Ptr<ns3::Packet const>> m_ackTrace;
+    TracedCallback<Ptr<ns3::Packet const>> m_dropTrace;
     TracedCallback<Ptr<ns3::Packet const>> m_macTxTrace;
 
     bool m_usePriorityAcks;
     bool m_useCarrierSensing;
+    bool m_slotted;
+    Time m_slotGuard;
+    uint32_t m_maxPayloadSize;
 
     
 }; /* class AlohaMac */
@@ -66,6 +66,7 @@ AlohaNetDevice::AlohaNetDevice (void)
     m_ifIndex = 0;
     m_mtu = 1500;
     m_mac = CreateObject<AlohaMac>();
+    m_mac->SetMaxPayloadSize(m_mtu);
     m_mac->SetReceiveCallback (MakeCallback (&AlohaNetDevice::Receive, this));
 }
 
@@ -165,6 +166,7 @@ bool
 AlohaNetDevice::SetMtu (const uint16_t mtu)
 {
     m_mtu = mtu;
+    m_mac->SetMaxPayloadSize(mtu);
     return true;
 }
 
@@ -298,7 +300,8 @@ int64_t
 AlohaNetDevice::AssignStreams(int64_t stream)
 {
         int64_t currentStream = stream;
-        currentStream += m_mac->AssignStreams(stream);
+        currentStream += m_mac->AssignStreams(currentStream);
+        currentStream += m_mac->GetPhy()->AssignStreams(currentStream);
         return (currentStream - stream);
 }
 
@@ -0,0 +1,453 @@
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include "ns3/boolean.h"
+#include "ns3/uinteger.h"
+#include "ns3/aloha-slot-engine.h"
+#include "ns3/aloha-net_device.h"
+#include "ns3/aloha-header.h"
+#include "ns3/aloha-trace-writer.h"
+
+#include <algorithm>
+#include <string>
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("AlohaSlotEngine");
+NS_OBJECT_ENSURE_REGISTERED (AlohaSlotEngine);
+
+TypeId
+AlohaSlotEngine::GetTypeId (void)
+{
+    static TypeId
+    tid =   TypeId ("ns3::AlohaSlotEngine")
+            .SetParent<Object> ()
+            .SetGroupName("Aloha")
+            .AddConstructor<AlohaSlotEngine>()
+            .AddAttribute ("PacketSize",
+                    "Size of each generated frame's MAC payload in bytes",
+                    UintegerValue(1028),
+                    MakeUintegerAccessor(&AlohaSlotEngine::m_packetSize),
+                    MakeUintegerChecker<uint32_t>())
+            .AddAttribute ("MaxPackets",
+                    "Packets generated per station (zero means no limit)",
+                    UintegerValue(100),
+                    MakeUintegerAccessor(&AlohaSlotEngine::m_maxPackets),
+                    MakeUintegerChecker<uint32_t>())
+            .AddAttribute ("Interval",
+                    "Time between generated packets",
+                    TimeValue(MilliSeconds(10)),
+                    MakeTimeAccessor(&AlohaSlotEngine::m_interval),
+                    MakeTimeChecker(TimeStep(1)))
+            .AddAttribute ("StartTime",
+                    "Time of each station's first packet",
+                    TimeValue(Seconds(0)),
+                    MakeTimeAccessor(&AlohaSlotEngine::m_startTime),
+                    MakeTimeChecker(Seconds(0)))
+            .AddAttribute ("StopTime",
+                    "Time at which the run ends",
+                    TimeValue(Seconds(10)),
+                    MakeTimeAccessor(&AlohaSlotEngine::m_stopTime),
+                    MakeTimeChecker(Seconds(0)))
+            .AddAttribute ("QueueSize",
+                    "Packets a station can hold, as its DropTailQueue",
+                    UintegerValue(100),
+                    MakeUintegerAccessor(&AlohaSlotEngine::m_queueSize),
+                    MakeUintegerChecker<uint32_t>(1));
+
+    return tid;
+}
+
+AlohaSlotEngine::AlohaSlotEngine()
+{
+    m_rand = CreateObject<UniformRandomVariable>();
+    m_words = 0;
+    m_slot = -1;
+    m_slotTime = 0;
+    m_dataTime = 0;
+    m_ackTime = 0;
+    m_timeout = 0;
+    m_slots = 0;
+    m_transmissions = 0;
+    m_deliveries = 0;
+}
+
+AlohaSlotEngine::~AlohaSlotEngine()
+{
+}
+
+void
+AlohaSlotEngine::DoDispose(void)
+{
+    m_channel = 0;
+    m_rand = 0;
+    m_writer = 0;
+    m_stations.clear();
+    Object::DoDispose();
+}
+
+void
+AlohaSlotEngine::Install(NetDeviceContainer devices)
+{
+    NS_ASSERT(devices.GetN() > 0);
+
+    Ptr<AlohaNetDevice> first = DynamicCast<AlohaNetDevice>(devices.Get(0));
+    NS_ABORT_MSG_UNLESS(first, "AlohaSlotEngine needs AlohaNetDevices");
+    m_channel = first->GetPhy()->GetChannel();
+
+    uint32_t n = m_channel->GetNDevices();
+    m_stations.assign(n, Station());
+    m_words = (n + 63) / 64;
+    m_active.assign(m_words, 0);
+    m_maskIndex.assign(n, -1);
+    m_masks.clear();
+
+    Ptr<AlohaMac> mac = first->GetMac();
+    Mac48Address sinkAddress = mac->GetSinkAddress();
+    uint32_t sink = n;
+
+    for (uint32_t i = 0; i < n; i++) {
+        Ptr<NetDevice> device = m_channel->GetDevice(i);
+        if (Mac48Address::ConvertFrom(device->GetAddress()) == sinkAddress) {
+            sink = i;
+        }
+        m_stations[i].installed = false;
+        m_stations[i].nodeId = device->GetNode()->GetId();
+        m_stations[i].nextArrival = -1;
+        m_channel->GetNeighbors(i, m_stations[i].neighbors);
+
+        for (NetDeviceContainer::Iterator d = devices.Begin(); d != devices.End(); ++d) {
+            if (*d == device) {
+                m_stations[i].installed = true;
+            }
+        }
+    }
+    NS_ABORT_MSG_IF(sink == n, "The sink is not attached to the channel");
+
+    m_slotTime = mac->GetSlotTime().GetTimeStep();
+    m_dataTime = first->GetPhy()->GetTransmissionTime(m_packetSize + AlohaHeader::SERIALIZED_SIZE).GetTimeStep();
+    m_ackTime = mac->GetAckTime().GetTimeStep();
+    m_timeout = m_dataTime + m_ackTime + MicroSeconds(2).GetTimeStep();
+
+    for (uint32_t i = 0; i < n; i++) {
+        Station &station = m_stations[i];
+        station.destination = sink;
+        station.toDestination = m_channel->GetPropagationDelay(i, sink).GetTimeStep();
+        station.fromDestination = m_channel->GetPropagationDelay(sink, i).GetTimeStep();
+
+        if (!station.installed) {
+            continue;
+        }
+
+        Ptr<AlohaNetDevice> device = DynamicCast<AlohaNetDevice>(m_channel->GetDevice(i));
+        NS_ABORT_MSG_UNLESS(device && device->GetPhy()->GetChannel() == m_channel,
+            "AlohaSlotEngine devices must share one channel");
+
+        Ptr<AlohaMac> stationMac = device->GetMac();
+        NS_ABORT_MSG_UNLESS(stationMac->IsSlotted(), "AlohaSlotEngine requires AlohaMac::Slotted");
+        NS_ABORT_MSG_IF(stationMac->GetUseCarrierSensing() || stationMac->GetUsePriorityAck(),
+            "AlohaSlotEngine does not model carrier sensing or priority ACKs");
+        NS_ABORT_MSG_UNLESS(stationMac->GetSlotTime().GetTimeStep() == m_slotTime,
+            "All stations must use the same slot");
+
+        Ptr<WirelessPhy> phy = device->GetPhy();
+        BooleanValue collisions;
+        phy->GetAttribute("EnableCollisions", collisions);
+        NS_ABORT_MSG_UNLESS(collisions.Get() && phy->GetPacketErrorRate() == 0.0 && phy->GetBitErrorRate() == 0.0,
+            "AlohaSlotEngine requires collisions and no PHY error model");
+
+        station.minExponent = stationMac->GetMinBackoffExponent();
+        station.maxExponent = stationMac->GetMaxBackoffExponent();
+        station.jitter = stationMac->GetJitter();
+    }
+
+    // only destinations need a neighbor mask
+    m_maskIndex[sink] = m_masks.size();
+    m_masks.push_back(std::vector<uint64_t>(m_words, 0));
+    for (uint32_t j : m_stations[sink].neighbors) {
+        m_masks.back()[j / 64] |= uint64_t(1) << (j % 64);
+    }
+
+    NS_LOG_INFO("Installed " << devices.GetN() << " stations, slot " << TimeStep(m_slotTime)
+                << ", sink node " << m_stations[sink].nodeId);
+}
+
+void
+AlohaSlotEngine::EnableAscii(Ptr<OutputStreamWrapper> stream)
+{
+    m_writer = Create<AlohaAsciiTraceWriter>(stream);
+}
+
+void
+AlohaSlotEngine::EnableTrace(Ptr<AlohaTraceWriter> writer)
+{
+    m_writer = writer;
+}
+
+int64_t
+AlohaSlotEngine::AssignStreams(int64_t stream)
+{
+    m_rand->SetStream(stream);
+    return 1;
+}
+
+int64_t
+AlohaSlotEngine::SlotAfter(int64_t time) const
+{
+    // first slot boundary at or after time
+    int64_t slot = (time + m_slotTime - 1) / m_slotTime;
+
+    // An attempt that lands on the boundary of the slot being resolved
+    // has missed it; the MAC would have sent it at the boundary itself.
+    return std::max(slot, m_slot + 1);
+}
+
+void
+AlohaSlotEngine::Schedule(uint32_t station, int64_t slot)
+{
+    m_transmitters[slot].push_back(station);
+}
+
+void
+AlohaSlotEngine::ScheduleArrival(uint32_t station)
+{
+    Station &s = m_stations[station];
+    if (m_maxPackets != 0 && s.sent >= m_maxPackets) {
+        s.nextArrival = -1;
+        return;
+    }
+
+    // arrivals inside the slot being resolved are picked up by its loop
+    int64_t slot = s.nextArrival / m_slotTime;
+    if (slot != m_slot) {
+        m_arrivals[slot].push_back(station);
+    }
+}
+
+bool
+AlohaSlotEngine::IsNeighbor(uint32_t station, uint32_t other) const
+{
+    const std::vector<uint32_t> &neighbors = m_stations[station].neighbors;
+    return std::binary_search(neighbors.begin(), neighbors.end(), other);
+}
+
+void
+AlohaSlotEngine::Arrive(uint32_t station, int64_t time)
+{
+    Station &s = m_stations[station];
+    m_records.push_back(Record {time, s.nodeId, -1});
+
+    if (s.queue.empty()) {
+        s.exponent = std::max(s.exponent, s.minExponent);
+        int64_t backoff = m_rand->GetInteger(0, 1u << s.exponent) * m_slotTime;
+        int64_t jitter = MicroSeconds(m_rand->GetInteger(0, s.jitter)).GetTimeStep();
+        Schedule(station, SlotAfter(time + backoff + jitter));
+    }
+
+    // DropTailQueue: the enqueue is traced even when the packet is dropped
+    if (s.queue.size() < m_queueSize) {
+        s.queue.push_back(time);
+    }
+
+    s.sent++;
+    s.nextArrival = time + m_interval.GetTimeStep();
+    ScheduleArrival(station);
+}
+
+void
+AlohaSlotEngine::Finish(uint32_t station, int64_t time, bool acked)
+{
+    Station &s = m_stations[station];
+    NS_ASSERT(!s.queue.empty());
+
+    if (acked) {
+        m_records.push_back(Record {time, s.nodeId, time - s.queue.front()});
+        s.queue.pop_front();
+        s.exponent = s.minExponent;
+        m_deliveries++;
+
+        if (s.queue.empty()) {
+            return;
+        }
+    } else {
+        s.exponent = std::min(s.exponent + 1, s.maxExponent);
+    }
+
+    int64_t backoff = m_rand->GetInteger(0, 1u << s.exponent) * m_slotTime;
+    Schedule(station, SlotAfter(time + backoff));
+}
+
+void
+AlohaSlotEngine::Resolve(int64_t slot)
+{
+    auto found = m_transmitters.find(slot);
+    if (found == m_transmitters.end()) {
+        return;
+    }
+
+    std::vector<uint32_t> transmitters;
+    transmitters.swap(found->second);
+    m_transmitters.erase(found);
+    m_transmissions += transmitters.size();
+
+    for (uint32_t i : transmitters) {
+        uint32_t word = i / 64;
+        if (m_active[word] == 0) {
+            m_activeWords.push_back(word);
+        }
+        m_active[word] |= uint64_t(1) << (i % 64);
+    }
+
+    int64_t start = slot * m_slotTime;
+    for (uint32_t i : transmitters) {
+        Station &s = m_stations[i];
+        uint32_t d = s.destination;
+        const std::vector<uint64_t> &mask = m_masks[m_maskIndex[d]];
+
+        // the destination hears exactly one frame, ours, and is not sending
+        bool acked = !(m_active[d / 64] >> (d % 64) & 1) && (mask[i / 64] >> (i % 64) & 1);
+        if (acked) {
+            uint32_t heard = 0;
+            for (uint32_t word : m_activeWords) {
+                heard += __builtin_popcountll(m_active[word] & mask[word]);
+            }
+            acked = (heard == 1);
+        }
+
+        // The ACK follows the data frame, so a longer link from another
+        // sender in range can still be arriving when it starts.
+        int64_t ackStart = start + s.toDestination + m_dataTime + s.fromDestination;
+        if (acked && transmitters.size() > 1) {
+            for (uint32_t j : transmitters) {
+                if (j != i && IsNeighbor(i, j)) {
+                    int64_t end = start + m_channel->GetPropagationDelay(j, i).GetTimeStep() + m_dataTime;
+                    if (end > ackStart) {
+                        acked = false;
+                        break;
+                    }
+                }
+            }
+        }
+
+        int64_t time = acked ? ackStart + m_ackTime : start + m_timeout;
+
+        // packets generated before the outcome is known join the queue first
+        while (s.nextArrival >= 0 && s.nextArrival < time && s.nextArrival / m_slotTime == slot) {
+            Arrive(i, s.nextArrival);
+        }
+        Finish(i, time, acked);
+    }
+
+    for (uint32_t word : m_activeWords) {
+        m_active[word] = 0;
+    }
+    m_activeWords.clear();
+}
+
+void
+AlohaSlotEngine::Flush(void)
+{
+    std::stable_sort(m_records.begin(), m_records.end(),
+        [](const Record &a, const Record &b) { return a.time < b.time; });
+
+    int64_t stop = m_stopTime.GetTimeStep();
+    for (const Record &record : m_records) {
+        if (!m_writer || record.time >= stop) {
+            continue;
+        }
+
+        if (record.delay < 0) {
+            m_writer->Write(AlohaTraceWriter::MakeEnqueue(TimeStep(record.time), record.node));
+        } else {
+            m_writer->Write(AlohaTraceWriter::MakeReceive(TimeStep(record.time), record.node,
+                                                          TimeStep(record.delay), m_packetSize));
+        }
+    }
+    m_records.clear();
+}
+
+void
+AlohaSlotEngine::Run(void)
+{
+    NS_ABORT_MSG_UNLESS(m_channel, "Install the engine on devices before running it");
+
+    m_transmitters.clear();
+    m_arrivals.clear();
+    m_records.clear();
+    m_slot = -1;
+    m_slots = 0;
+    m_transmissions = 0;
+    m_deliveries = 0;
+
+    for (uint32_t i = 0; i < m_stations.size(); i++) {
+        Station &s = m_stations[i];
+        s.queue.clear();
+        s.exponent = s.minExponent;
+        if (!s.installed || s.destination == i) {
+            continue;
+        }
+        s.sent = 0;
+        s.nextArrival = m_startTime.GetTimeStep();
+        ScheduleArrival(i);
+    }
+
+    int64_t stop = m_stopTime.GetTimeStep();
+    while (!m_transmitters.empty() || !m_arrivals.empty()) {
+        int64_t slot = INT64_MAX;
+        if (!m_transmitters.empty()) {
+            slot = m_transmitters.begin()->first;
+        }
+        if (!m_arrivals.empty()) {
+            slot = std::min(slot, m_arrivals.begin()->first);
+        }
+        if (slot * m_slotTime >= stop) {
+            break;
+        }
+
+        m_slot = slot;
+        m_slots++;
+        Resolve(slot);
+
+        auto found = m_arrivals.find(slot);
+        if (found != m_arrivals.end()) {
+            std::vector<uint32_t> stations;
+            stations.swap(found->second);
+            m_arrivals.erase(found);
+
+            for (uint32_t i : stations) {
+                Station &s = m_stations[i];
+                while (s.nextArrival >= 0 && s.nextArrival / m_slotTime == slot) {
+                    Arrive(i, s.nextArrival);
+                }
+            }
+        }
+
+        Flush();
+    }
+
+    if (m_writer) {
+        m_writer->Close();
+    }
+
+    NS_LOG_INFO("Ran " << m_slots << " busy slots: " << m_transmissions << " transmissions, "
+                << m_deliveries << " deliveries");
+}
+
+uint64_t
+AlohaSlotEngine::GetSlots(void) const
+{
+    return m_slots;
+}
+
+uint64_t
+AlohaSlotEngine::GetTransmissions(void) const
+{
+    return m_transmissions;
+}
+
+uint64_t
+AlohaSlotEngine::GetDeliveries(void) const
+{
+    return m_deliveries;
+}
+
+} /* namespace ns3 */
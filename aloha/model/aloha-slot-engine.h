@@ -0,0 +1,141 @@
+#ifndef SLOTTED_ALOHA_SLOT_ENGINE_H
+#define SLOTTED_ALOHA_SLOT_ENGINE_H
+
+#include <stdint.h>
+#include <deque>
+#include <map>
+#include <vector>
+
+#include "ns3/object.h"
+#include "ns3/nstime.h"
+#include "ns3/net-device-container.h"
+#include "ns3/output-stream-wrapper.h"
+#include "ns3/random-variable-stream.h"
+
+#include "ns3/wireless-channel.h"
+#include "ns3/aloha-trace-writer.h"
+
+namespace ns3 {
+
+/*
+ * Slot-synchronous replacement for a slotted AlohaMac run.
+ *
+ * Instead of scheduling timers and per-receiver events, the engine steps
+ * through the slots that have something in them. The stations transmitting
+ * in a slot form a bitset, and a data frame gets through when the AND of
+ * that set with its destination's neighbor mask has a popcount of one and
+ * the destination is not itself transmitting. Backoff exponents, jitter,
+ * slot length and airtimes are read from the installed devices' MACs and
+ * PHYs, and neighbor sets and delays from their (stationary) channel.
+ *
+ * Every station runs a UdpEchoClient-like source toward the sink: MaxPackets
+ * frames of PacketSize bytes (the MAC payload, so including IP and UDP
+ * headers), one per Interval from StartTime. The engine writes the same '+'
+ * and 'r' records as AlohaHelper's traces.
+ *
+ * Only the base configuration is modelled: slotted MACs without carrier
+ * sensing or priority ACKs, collisions enabled and no PHY error model.
+ * ARP and other upper-layer traffic are not simulated.
+ */
+class AlohaSlotEngine : public Object {
+
+public:
+
+    static TypeId GetTypeId (void);
+
+    AlohaSlotEngine();
+    virtual ~AlohaSlotEngine();
+
+    /* AlohaNetDevices sharing one channel, one of which is the sink */
+    void Install(NetDeviceContainer devices);
+    void EnableAscii(Ptr<OutputStreamWrapper> stream);
+    void EnableTrace(Ptr<AlohaTraceWriter> writer);
+    int64_t AssignStreams(int64_t stream);
+
+    /* Runs from time zero to StopTime, then closes the trace writer. */
+    void Run(void);
+
+    uint64_t GetSlots(void) const;
+    uint64_t GetTransmissions(void) const;
+    uint64_t GetDeliveries(void) const;
+
+protected:
+
+    virtual void DoDispose(void) override;
+
+private:
+
+    struct Station
+    {
+        bool installed;                 /* false for devices outside the container */
+        uint32_t nodeId;
+        uint32_t destination;           /* channel index of the sink */
+        uint32_t minExponent;
+        uint32_t maxExponent;
+        uint32_t exponent;
+        uint32_t jitter;                /* microseconds */
+        uint32_t sent;                  /* packets generated so far */
+        int64_t nextArrival;            /* time step, or -1 when done */
+        int64_t toDestination;          /* propagation delays, in time steps */
+        int64_t fromDestination;
+        std::deque<int64_t> queue;      /* enqueue time steps */
+        std::vector<uint32_t> neighbors;
+    };
+
+    struct Record
+    {
+        int64_t time;
+        uint32_t node;
+        int64_t delay;                  /* -1 for an enqueue */
+    };
+
+    void Schedule(uint32_t station, int64_t slot);
+    void ScheduleArrival(uint32_t station);
+    int64_t SlotAfter(int64_t time) const;
+    bool IsNeighbor(uint32_t station, uint32_t other) const;
+    void Arrive(uint32_t station, int64_t time);
+    void Finish(uint32_t station, int64_t time, bool acked);
+    void Resolve(int64_t slot);
+    void Flush(void);
+
+    Ptr<WirelessChannel> m_channel;
+    Ptr<UniformRandomVariable> m_rand;
+    Ptr<AlohaTraceWriter> m_writer;
+
+    uint32_t m_packetSize;
+    uint32_t m_maxPackets;
+    uint32_t m_queueSize;
+    Time m_interval;
+    Time m_startTime;
+    Time m_stopTime;
+
+    std::vector<Station> m_stations;
+    uint32_t m_words;
+
+    /* neighbor masks of the stations that are some station's destination */
+    std::vector<int32_t> m_maskIndex;
+    std::vector< std::vector<uint64_t> > m_masks;
+
+    /* stations with an attempt or an arrival in a slot, keyed by slot */
+    std::map< int64_t, std::vector<uint32_t> > m_transmitters;
+    std::map< int64_t, std::vector<uint32_t> > m_arrivals;
+
+    std::vector<uint64_t> m_active;
+    std::vector<uint32_t> m_activeWords;
+    std::vector<Record> m_records;
+
+    int64_t m_slot;                     /* slot being resolved */
+    int64_t m_slotTime;
+    int64_t m_dataTime;
+    int64_t m_ackTime;
+    int64_t m_timeout;
+
+    uint64_t m_slots;
+    uint64_t m_transmissions;
+    uint64_t m_deliveries;
+
+}; /* class AlohaSlotEngine */
+
+} /* namespace ns3 */
+
+#endif /* SLOTTED_ALOHA_SLOT_ENGINE_H */
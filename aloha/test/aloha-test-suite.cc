@@ -0,0 +1,666 @@
+#include "ns3/test.h"
+#include "ns3/simulator.h"
+#include "ns3/node-container.h"
+#include "ns3/mobility-helper.h"
+#include "ns3/wireless-channel.h"
+#include "ns3/wireless-phy.h"
+#include "ns3/wireless-plcp-header.h"
+#include "ns3/wireless-transmission-vector.h"
+#include "ns3/wireless-mac-upcalls.h"
+#include "ns3/aloha-helper.h"
+#include "ns3/aloha-delay-table.h"
+#include "ns3/aloha-trace-writer.h"
+#include "ns3/aloha-async-trace-writer.h"
+#include "ns3/aloha-mac.h"
+#include "ns3/aloha-net_device.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cmath>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <thread>
+#include <vector>
+
+using namespace ns3;
+
+/*
+ * A sender next to a sink. Everything an ACK triggers (the upcall into
+ * the node, which asserts its context in debug builds, and the timer for
+ * the next transmission) must run in the receiving node's context.
+ */
+class AlohaAckContextTestCase : public TestCase
+{
+public:
+    AlohaAckContextTestCase();
+
+private:
+    void DoRun(void) override;
+
+    void AckReceived(Ptr<const Packet> packet);
+    void Transmitted(Ptr<const Packet> packet);
+
+    uint32_t m_node;
+    uint32_t m_acks;
+    uint32_t m_transmissions;
+};
+
+AlohaAckContextTestCase::AlohaAckContextTestCase()
+    : TestCase("ACKs and the transmissions they start run in the receiver's context")
+{
+}
+
+void
+AlohaAckContextTestCase::AckReceived(Ptr<const Packet> packet)
+{
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetContext(), m_node, "ACK handled in the wrong context");
+    m_acks++;
+}
+
+void
+AlohaAckContextTestCase::Transmitted(Ptr<const Packet> packet)
+{
+    NS_TEST_EXPECT_MSG_EQ(Simulator::GetContext(), m_node, "Transmission timer ran in the wrong context");
+    m_transmissions++;
+}
+
+void
+AlohaAckContextTestCase::DoRun(void)
+{
+    NodeContainer nodes(2);
+
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+    positions->Add(Vector(0, 0, 0));
+    positions->Add(Vector(10, 0, 0));
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator(positions);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+
+    AlohaHelper aloha;
+    NetDeviceContainer devices = aloha.Install(nodes);
+    aloha.AssignStreams(devices, 0);
+
+    Mac48Address sink = Mac48Address::ConvertFrom(devices.Get(0)->GetAddress());
+    for (uint32_t i = 0; i < devices.GetN(); i++) {
+        DynamicCast<AlohaNetDevice>(devices.Get(i))->SetSinkAddress(sink);
+    }
+
+    Ptr<AlohaNetDevice> sender = DynamicCast<AlohaNetDevice>(devices.Get(1));
+    m_node = nodes.Get(1)->GetId();
+    m_acks = 0;
+    m_transmissions = 0;
+    sender->GetMac()->TraceConnectWithoutContext("AckReceive",
+                            MakeCallback(&AlohaAckContextTestCase::AckReceived, this));
+    sender->GetMac()->TraceConnectWithoutContext("MacTx",
+                            MakeCallback(&AlohaAckContextTestCase::Transmitted, this));
+
+    // two packets, so the second transmission is started by the first ACK
+    for (uint32_t i = 0; i < 2; i++) {
+        Simulator::ScheduleWithContext(m_node, Seconds(1), [sender, sink]() {
+            sender->Send(Create<Packet>(100), sink, 0);
+        });
+    }
+    Simulator::Stop(Seconds(2));
+    Simulator::Run();
+    Simulator::Destroy();
+
+    NS_TEST_ASSERT_MSG_EQ(m_acks, 2u, "Both packets should be acknowledged");
+    NS_TEST_ASSERT_MSG_EQ(m_transmissions, 2u, "Each packet should be sent once");
+}
+
+/*
+ * A lone sender on a lossy link to the sink. With no other traffic every
+ * attempt is either acknowledged or lost to the sink's error model, so
+ * the fraction of unacknowledged attempts estimates the PER of the
+ * sender's (fixed) frame size, 1 - (1 - per)(1 - ber)^(8s).
+ */
+class AlohaErrorModelTestCase : public TestCase
+{
+public:
+    AlohaErrorModelTestCase();
+
+private:
+    void DoRun(void) override;
+
+    void AckReceived(Ptr<const Packet> packet);
+    void Transmitted(Ptr<const Packet> packet);
+
+    Ptr<AlohaNetDevice> m_sender;
+    Mac48Address m_sink;
+    uint32_t m_packets;
+    uint32_t m_acks;
+    uint32_t m_transmissions;
+    uint32_t m_frameSize;
+};
+
+AlohaErrorModelTestCase::AlohaErrorModelTestCase()
+    : TestCase("Frames are lost at the PER of their own size")
+{
+}
+
+void
+AlohaErrorModelTestCase::AckReceived(Ptr<const Packet> packet)
+{
+    m_acks++;
+    if (m_acks < m_packets) {
+        m_sender->Send(Create<Packet>(100), m_sink, 0);
+    }
+}
+
+void
+AlohaErrorModelTestCase::Transmitted(Ptr<const Packet> packet)
+{
+    m_transmissions++;
+    m_frameSize = packet->GetSize() + PlcpHeader::SERIALIZED_SIZE;
+}
+
+void
+AlohaErrorModelTestCase::DoRun(void)
+{
+    const double per = 0.05;
+    const double ber = 1e-3;
+
+    NodeContainer nodes(2);
+
+    Ptr<ListPositionAllocator> positions = CreateObject<ListPositionAllocator>();
+    positions->Add(Vector(0, 0, 0));
+    positions->Add(Vector(10, 0, 0));
+    MobilityHelper mobility;
+    mobility.SetPositionAllocator(positions);
+    mobility.SetMobilityModel("ns3::ConstantPositionMobilityModel");
+    mobility.Install(nodes);
+
+    AlohaHelper aloha;
+    NetDeviceContainer devices = aloha.Install(nodes);
+    aloha.AssignStreams(devices, 0);
+
+    m_sink = Mac48Address::ConvertFrom(devices.Get(0)->GetAddress());
+    for (uint32_t i = 0; i < devices.GetN(); i++) {
+        DynamicCast<AlohaNetDevice>(devices.Get(i))->SetSinkAddress(m_sink);
+    }
+
+    // only data frames from the sender are lossy, never its ACKs
+    DynamicCast<AlohaNetDevice>(devices.Get(0))->GetPhy()->SetLinkErrorRate(nodes.Get(1)->GetId(), per, ber);
+
+    m_sender = DynamicCast<AlohaNetDevice>(devices.Get(1));
+    m_packets = 1000;
+    m_acks = 0;
+    m_transmissions = 0;
+    m_frameSize = 0;
+    m_sender->GetMac()->TraceConnectWithoutContext("AckReceive",
+                            MakeCallback(&AlohaErrorModelTestCase::AckReceived, this));
+    m_sender->GetMac()->TraceConnectWithoutContext("MacTx",
+                            MakeCallback(&AlohaErrorModelTestCase::Transmitted, this));
+
+    // one packet at a time, the next sent when the previous is acknowledged
+    Ptr<AlohaNetDevice> sender = m_sender;
+    Mac48Address sink = m_sink;
+    Simulator::ScheduleWithContext(nodes.Get(1)->GetId(), Seconds(1), [sender, sink]() {
+        sender->Send(Create<Packet>(100), sink, 0);
+    });
+    Simulator::Stop(Seconds(10000));
+    Simulator::Run();
+    Simulator::Destroy();
+    m_sender = 0;
+
+    NS_TEST_ASSERT_MSG_EQ(m_acks, m_packets, "Every packet should get through eventually");
+
+    double expected = 1 - (1 - per) * std::pow(1 - ber, 8.0 * m_frameSize);
+    double observed = 1 - double(m_acks) / m_transmissions;
+    double sigma = std::sqrt(expected * (1 - expected) / m_transmissions);
+    NS_TEST_EXPECT_MSG_EQ_TOL(observed, expected, 4 * sigma, "Loss rate differs from the PER of a "
+                              << m_frameSize << "-byte frame");
+}
+
+/* records the payload size of every frame the PHY hands up */
+class AlohaReceiveCounter : public WirelessMacUpcalls
+{
+public:
+    void Receive(Ptr<Packet> packet) override { m_sizes.push_back(packet->GetSize()); }
+
+    std::vector<uint32_t> m_sizes;
+};
+
+/*
+ * Frames fed straight into a PHY. The epoch rule must deliver exactly the
+ * frames the rule it replaced did, which corrupted every reception in
+ * progress on each overlapping arrival: a frame survives if and only if
+ * it overlaps no other frame. Each frame has its own payload size so the
+ * deliveries identify it.
+ */
+class AlohaEpochCollisionTestCase : public TestCase
+{
+public:
+    AlohaEpochCollisionTestCase();
+
+private:
+    void DoRun(void) override;
+};
+
+AlohaEpochCollisionTestCase::AlohaEpochCollisionTestCase()
+    : TestCase("Epoch collisions corrupt the same frames as corrupting every overlap")
+{
+}
+
+void
+AlohaEpochCollisionTestCase::DoRun(void)
+{
+    struct Frame {
+        uint32_t start;   /* microseconds */
+        uint32_t end;
+        uint32_t size;
+    };
+    const std::vector<Frame> frames = {
+        // one long frame overlapping two that do not overlap each other
+        {0, 10, 100}, {2, 4, 101}, {6, 8, 102},
+        // a chain: the first and the last do not overlap
+        {20, 30, 103}, {25, 35, 104}, {32, 40, 105},
+        // three at once
+        {50, 60, 106}, {51, 59, 107}, {52, 58, 108},
+        // alone, between and after the groups
+        {12, 18, 109}, {70, 80, 110},
+        // starts as the previous one ends
+        {80, 90, 111},
+    };
+
+    Ptr<WirelessPhy> phy = CreateObject<WirelessPhy>();
+    Ptr<AlohaReceiveCounter> counter = Create<AlohaReceiveCounter>();
+    phy->SetMacUpcalls(counter);
+
+    for (const Frame &frame : frames) {
+        Ptr<Packet> packet = Create<Packet>(frame.size);
+        packet->AddHeader(PlcpHeader());
+        Time duration = MicroSeconds(frame.end - frame.start);
+        Ptr<const TransmissionVector> rxVector =
+            Create<TransmissionVector>(packet, Ptr<NetDevice>(), Ptr<MobilityModel>(), duration, false);
+        uint32_t handle = phy->Reserve();
+        Simulator::Schedule(MicroSeconds(frame.start), &WirelessPhy::StartReceive, phy, rxVector, handle);
+        Simulator::Schedule(MicroSeconds(frame.end), &WirelessPhy::FinishReceive, phy, rxVector, handle);
+    }
+    Simulator::Run();
+    Simulator::Destroy();
+
+    std::vector<uint32_t> expected;
+    for (const Frame &frame : frames) {
+        bool overlaps = false;
+        for (const Frame &other : frames) {
+            if (&other != &frame && other.start < frame.end && other.end > frame.start) {
+                overlaps = true;
+            }
+        }
+        if (!overlaps) {
+            expected.push_back(frame.size);
+        }
+    }
+
+    std::vector<uint32_t> received = counter->m_sizes;
+    std::sort(received.begin(), received.end());
+    NS_TEST_ASSERT_MSG_EQ(received.size(), expected.size(), "Wrong number of frames delivered");
+    for (uint32_t i = 0; i < expected.size(); i++) {
+        NS_TEST_EXPECT_MSG_EQ(received[i], expected[i], "Wrong frame delivered");
+    }
+}
+
+/*
+ * AlohaDelayTable against a std::map. A table for four packets has eight
+ * slots, and UIDs from a range of 32 collide often enough that probe runs
+ * wrap past the last slot and backward shifts cross the wrap.
+ */
+class AlohaDelayTableTestCase : public TestCase
+{
+public:
+    AlohaDelayTableTestCase();
+
+private:
+    void DoRun(void) override;
+};
+
+AlohaDelayTableTestCase::AlohaDelayTableTestCase()
+    : TestCase("The delay table keeps every entry across deletions, wraps and growth")
+{
+}
+
+void
+AlohaDelayTableTestCase::DoRun(void)
+{
+    std::mt19937 rng(1);
+    AlohaDelayTable table(4);
+    std::map<uint32_t, Time> reference;
+
+    for (uint32_t op = 0; op < 100000; op++) {
+        uint32_t uid = rng() % 32;
+        Time enqueued;
+        bool found = table.Remove(uid, enqueued);
+        auto expected = reference.find(uid);
+        NS_TEST_ASSERT_MSG_EQ(found, expected != reference.end(), "Lookup of UID " << uid << " is wrong");
+        if (found) {
+            NS_TEST_ASSERT_MSG_EQ(enqueued, expected->second, "UID " << uid << " has the wrong time");
+            reference.erase(expected);
+        } else if (reference.size() < 4) {
+            table.Insert(uid, NanoSeconds(op));
+            reference[uid] = NanoSeconds(op);
+        }
+        NS_TEST_ASSERT_MSG_EQ(table.GetSize(), reference.size(), "Wrong size");
+    }
+    NS_TEST_EXPECT_MSG_EQ(table.GetPeak(), 4u, "The peak should reach the capacity");
+
+    // break the capacity bound: the table grows and keeps its entries
+    for (uint32_t uid = 100; uid < 164; uid++) {
+        table.Insert(uid, NanoSeconds(uid));
+    }
+    NS_TEST_EXPECT_MSG_EQ(table.GetPeak(), 64u + reference.size(), "The peak should follow the size");
+    NS_TEST_EXPECT_MSG_EQ(table.GetCapacity(), 4u, "Growing should not change the nominal capacity");
+    for (uint32_t uid = 100; uid < 164; uid += 2) {
+        Time enqueued;
+        NS_TEST_ASSERT_MSG_EQ(table.Remove(uid, enqueued), true, "UID " << uid << " lost when growing");
+        NS_TEST_EXPECT_MSG_EQ(enqueued, NanoSeconds(uid), "UID " << uid << " has the wrong time");
+    }
+    for (auto &entry : reference) {
+        Time enqueued;
+        NS_TEST_ASSERT_MSG_EQ(table.Remove(entry.first, enqueued), true, "UID " << entry.first << " lost when growing");
+        NS_TEST_EXPECT_MSG_EQ(enqueued, entry.second, "UID " << entry.first << " has the wrong time");
+    }
+    for (uint32_t uid = 101; uid < 164; uid += 2) {
+        Time enqueued;
+        NS_TEST_ASSERT_MSG_EQ(table.Remove(uid, enqueued), true, "UID " << uid << " lost after deletions");
+        NS_TEST_EXPECT_MSG_EQ(enqueued, NanoSeconds(uid), "UID " << uid << " has the wrong time");
+    }
+    NS_TEST_EXPECT_MSG_EQ(table.GetSize(), 0u, "The table should be empty");
+}
+
+/* enqueues and receptions from a few nodes, in time order */
+static std::vector<AlohaTraceRecord>
+MakeTraceRecords(uint32_t n)
+{
+    std::vector<AlohaTraceRecord> records;
+    for (uint32_t i = 0; i < n; i++) {
+        Time now = MicroSeconds(10 * i + i % 7);
+        if (i % 3 == 0) {
+            records.push_back(AlohaTraceWriter::MakeEnqueue(now, i % 5));
+        } else {
+            records.push_back(AlohaTraceWriter::MakeReceive(now, i % 5, MicroSeconds(i % 1000), 100 + i % 1400));
+        }
+    }
+    return records;
+}
+
+static std::vector<char>
+ReadTraceFile(std::string filename)
+{
+    std::ifstream file(filename, std::ios::binary);
+    return std::vector<char>(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>());
+}
+
+/* reads a T at byte offset in a trace file */
+template <typename T>
+static T
+ReadTraceValue(const std::vector<char> &bytes, std::size_t offset)
+{
+    T value;
+    std::memcpy(&value, bytes.data() + offset, sizeof(value));
+    return value;
+}
+
+/*
+ * Records written through the binary writer, across several of its
+ * buffer flushes, read back byte for byte behind the documented header.
+ */
+class AlohaBinaryTraceTestCase : public TestCase
+{
+public:
+    AlohaBinaryTraceTestCase();
+
+private:
+    void DoRun(void) override;
+};
+
+AlohaBinaryTraceTestCase::AlohaBinaryTraceTestCase()
+    : TestCase("Binary traces read back as the records written")
+{
+}
+
+void
+AlohaBinaryTraceTestCase::DoRun(void)
+{
+    std::string filename = CreateTempDirFilename("aloha.bin");
+    std::vector<AlohaTraceRecord> records = MakeTraceRecords(70000);
+
+    Ptr<AlohaBinaryTraceWriter> writer = Create<AlohaBinaryTraceWriter>(filename);
+    for (const AlohaTraceRecord &record : records) {
+        writer->Write(record);
+    }
+    writer->Close();
+
+    std::vector<char> bytes = ReadTraceFile(filename);
+    NS_TEST_ASSERT_MSG_EQ(bytes.size(), 32 + 32 * records.size(), "Wrong file size");
+    NS_TEST_EXPECT_MSG_EQ(std::string(bytes.data(), 8), "ALOHATRC", "Wrong magic");
+    NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<uint32_t>(bytes, 8), AlohaBinaryTraceWriter::VERSION, "Wrong version");
+    NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<uint32_t>(bytes, 12), 32u, "Wrong header size");
+    NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<uint32_t>(bytes, 16), 32u, "Wrong record size");
+    NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<int64_t>(bytes, 24), Seconds(1).GetTimeStep(), "Wrong time resolution");
+
+    for (uint32_t i = 0; i < records.size(); i++) {
+        AlohaTraceRecord read = ReadTraceValue<AlohaTraceRecord>(bytes, 32 + 32 * i);
+        NS_TEST_ASSERT_MSG_EQ(std::memcmp(&read, &records[i], sizeof(read)), 0, "Record " << i << " differs");
+    }
+}
+
+/*
+ * Records written through the columnar writer in small chunks, read back
+ * column by column. The footers must give each chunk's count and time
+ * range, and selecting chunks by their footers must find exactly the
+ * records of a time window.
+ */
+class AlohaColumnarTraceTestCase : public TestCase
+{
+public:
+    AlohaColumnarTraceTestCase();
+
+private:
+    void DoRun(void) override;
+};
+
+AlohaColumnarTraceTestCase::AlohaColumnarTraceTestCase()
+    : TestCase("Columnar traces read back as the records written")
+{
+}
+
+void
+AlohaColumnarTraceTestCase::DoRun(void)
+{
+    const uint32_t chunkRecords = 64;
+    const uint32_t footerSize = AlohaColumnarTraceWriter::FOOTER_SIZE;
+    std::string prefix = CreateTempDirFilename("aloha");
+    std::vector<AlohaTraceRecord> records = MakeTraceRecords(3 * chunkRecords + 10);
+    uint32_t chunks = (records.size() + chunkRecords - 1) / chunkRecords;
+
+    Ptr<AlohaColumnarTraceWriter> writer = Create<AlohaColumnarTraceWriter>(prefix, chunkRecords);
+    for (const AlohaTraceRecord &record : records) {
+        writer->Write(record);
+    }
+    writer->Close();
+
+    const char *names[] = {"time", "delay", "node", "size", "event"};
+    const uint32_t sizes[] = {8, 8, 4, 4, 1};
+    std::vector<std::vector<char>> columns;
+    for (uint32_t c = 0; c < 5; c++) {
+        std::vector<char> bytes = ReadTraceFile(prefix + "." + names[c]);
+        uint32_t stride = chunkRecords * sizes[c] + footerSize;
+        NS_TEST_ASSERT_MSG_EQ(bytes.size(), 32 + chunks * stride, "Wrong size of the " << names[c] << " column");
+        NS_TEST_EXPECT_MSG_EQ(std::string(bytes.data(), 8), "ALOHACOL", "Wrong magic");
+        NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<uint32_t>(bytes, 8), AlohaColumnarTraceWriter::VERSION, "Wrong version");
+        NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<uint32_t>(bytes, 12), 32u, "Wrong header size");
+        NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<uint32_t>(bytes, 16), chunkRecords, "Wrong chunk size");
+        NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<uint32_t>(bytes, 20), sizes[c], "Wrong value size");
+        NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<int64_t>(bytes, 24), Seconds(1).GetTimeStep(), "Wrong time resolution");
+
+        // every column repeats the same footers
+        for (uint32_t k = 0; k < chunks; k++) {
+            std::size_t footer = 32 + k * stride + chunkRecords * sizes[c];
+            uint32_t first = k * chunkRecords;
+            uint32_t count = std::min<uint32_t>(chunkRecords, records.size() - first);
+            int64_t minTime = records[first].time;
+            int64_t maxTime = records[first].time;
+            for (uint32_t i = first; i < first + count; i++) {
+                minTime = std::min(minTime, records[i].time);
+                maxTime = std::max(maxTime, records[i].time);
+            }
+            NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<uint32_t>(bytes, footer), count, "Wrong count in chunk " << k);
+            NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<int64_t>(bytes, footer + 8), minTime, "Wrong minimum in chunk " << k);
+            NS_TEST_EXPECT_MSG_EQ(ReadTraceValue<int64_t>(bytes, footer + 16), maxTime, "Wrong maximum in chunk " << k);
+        }
+        columns.push_back(bytes);
+    }
+
+    for (uint32_t i = 0; i < records.size(); i++) {
+        std::size_t wide = 32 + (i / chunkRecords) * (chunkRecords * 8 + footerSize);
+        std::size_t narrow = 32 + (i / chunkRecords) * (chunkRecords * 4 + footerSize);
+        std::size_t byte = 32 + (i / chunkRecords) * (chunkRecords + footerSize);
+        uint32_t j = i % chunkRecords;
+        NS_TEST_ASSERT_MSG_EQ(ReadTraceValue<int64_t>(columns[0], wide + 8 * j), records[i].time, "Time of record " << i);
+        NS_TEST_ASSERT_MSG_EQ(ReadTraceValue<int64_t>(columns[1], wide + 8 * j), records[i].delay, "Delay of record " << i);
+        NS_TEST_ASSERT_MSG_EQ(ReadTraceValue<uint32_t>(columns[2], narrow + 4 * j), records[i].node, "Node of record " << i);
+        NS_TEST_ASSERT_MSG_EQ(ReadTraceValue<uint32_t>(columns[3], narrow + 4 * j), records[i].size, "Size of record " << i);
+        NS_TEST_ASSERT_MSG_EQ(ReadTraceValue<uint8_t>(columns[4], byte + j), records[i].event, "Event of record " << i);
+    }
+
+    // a window starting and ending inside chunks, found through the time footers only
+    int64_t start = records[chunkRecords / 2].time;
+    int64_t stop = records[2 * chunkRecords + 3].time;
+    std::vector<int64_t> found;
+    for (uint32_t k = 0; k < chunks; k++) {
+        std::size_t base = 32 + k * (chunkRecords * 8 + footerSize);
+        std::size_t footer = base + chunkRecords * 8;
+        if (ReadTraceValue<int64_t>(columns[0], footer + 8) > stop
+            || ReadTraceValue<int64_t>(columns[0], footer + 16) < start) {
+            continue;
+        }
+        uint32_t count = ReadTraceValue<uint32_t>(columns[0], footer);
+        for (uint32_t j = 0; j < count; j++) {
+            int64_t time = ReadTraceValue<int64_t>(columns[0], base + 8 * j);
+            if (time >= start && time <= stop) {
+                found.push_back(time);
+            }
+        }
+    }
+    std::vector<int64_t> expected;
+    for (const AlohaTraceRecord &record : records) {
+        if (record.time >= start && record.time <= stop) {
+            expected.push_back(record.time);
+        }
+    }
+    NS_TEST_ASSERT_MSG_EQ(found.size(), expected.size(), "The footers missed records of the window");
+    for (uint32_t i = 0; i < expected.size(); i++) {
+        NS_TEST_EXPECT_MSG_EQ(found[i], expected[i], "Wrong record in the window");
+    }
+}
+
+/*
+ * Keeps what it is given. Write holds the draining thread until the gate
+ * opens, which lets a test fill the ring on purpose.
+ */
+class AlohaGatedTraceWriter : public AlohaTraceWriter
+{
+public:
+    AlohaGatedTraceWriter(bool open)
+        : m_open(open),
+          m_closed(false)
+    {
+    }
+
+    void Write(const AlohaTraceRecord &record) override
+    {
+        while (!m_open.load(std::memory_order_acquire)) {
+            std::this_thread::yield();
+        }
+        m_records.push_back(record);
+    }
+
+    void Close(void) override { m_closed = true; }
+
+    std::atomic<bool> m_open;
+    bool m_closed;
+    std::vector<AlohaTraceRecord> m_records;
+};
+
+/*
+ * The asynchronous writer hands records on in order, losing none under
+ * BLOCK, and under DROP discards exactly what does not fit the ring.
+ */
+class AlohaAsyncTraceTestCase : public TestCase
+{
+public:
+    AlohaAsyncTraceTestCase();
+
+private:
+    void DoRun(void) override;
+};
+
+AlohaAsyncTraceTestCase::AlohaAsyncTraceTestCase()
+    : TestCase("Asynchronous traces keep their order and count their drops")
+{
+}
+
+void
+AlohaAsyncTraceTestCase::DoRun(void)
+{
+    std::vector<AlohaTraceRecord> records = MakeTraceRecords(10000);
+
+    // a ring far smaller than the trace, so the producer keeps waiting on it
+    Ptr<AlohaGatedTraceWriter> inner = Create<AlohaGatedTraceWriter>(true);
+    Ptr<AlohaAsyncTraceWriter> writer = Create<AlohaAsyncTraceWriter>(inner, 16, AlohaAsyncTraceWriter::BLOCK);
+    for (const AlohaTraceRecord &record : records) {
+        writer->Write(record);
+    }
+    writer->Close();
+
+    NS_TEST_EXPECT_MSG_EQ(inner->m_closed, true, "Close should close the wrapped writer");
+    NS_TEST_EXPECT_MSG_EQ(writer->GetDropped(), 0u, "BLOCK should never drop");
+    NS_TEST_ASSERT_MSG_EQ(inner->m_records.size(), records.size(), "Records were lost");
+    for (uint32_t i = 0; i < records.size(); i++) {
+        NS_TEST_ASSERT_MSG_EQ(std::memcmp(&inner->m_records[i], &records[i], sizeof(records[i])), 0,
+                              "Record " << i << " out of order");
+    }
+
+    // The draining thread hands slots back only after writing them, and
+    // the gate holds it on the first one, so the ring takes exactly its
+    // capacity and everything after that is dropped.
+    inner = Create<AlohaGatedTraceWriter>(false);
+    writer = Create<AlohaAsyncTraceWriter>(inner, 16, AlohaAsyncTraceWriter::DROP);
+    for (uint32_t i = 0; i < 100; i++) {
+        writer->Write(records[i]);
+    }
+    NS_TEST_EXPECT_MSG_EQ(writer->GetDropped(), 84u, "Everything past the ring should be dropped");
+    inner->m_open.store(true, std::memory_order_release);
+    writer->Close();
+
+    NS_TEST_ASSERT_MSG_EQ(inner->m_records.size(), 16u, "The ring's records should all be written");
+    for (uint32_t i = 0; i < 16; i++) {
+        NS_TEST_ASSERT_MSG_EQ(std::memcmp(&inner->m_records[i], &records[i], sizeof(records[i])), 0,
+                              "Record " << i << " out of order");
+    }
+}
+
+class AlohaTestSuite : public TestSuite
+{
+public:
+    AlohaTestSuite();
+};
+
+AlohaTestSuite::AlohaTestSuite()
+    : TestSuite("aloha", Type::UNIT)
+{
+    AddTestCase(new AlohaAckContextTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new AlohaErrorModelTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new AlohaEpochCollisionTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new AlohaDelayTableTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new AlohaBinaryTraceTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new AlohaColumnarTraceTestCase, TestCase::Duration::QUICK);
+    AddTestCase(new AlohaAsyncTraceTestCase, TestCase::Duration::QUICK);
+}
+
+static AlohaTestSuite g_alohaTestSuite;
@@ -1,16 +1,124 @@
 import pandas as pd
+import numpy as np
 import matplotlib.pyplot as plt
 import argparse
+import sys
 
 # Create the argument parser
 parser = argparse.ArgumentParser()
-parser.add_argument('--sample_rate', type=str, required=True, help="The sample rate value")
+parser.add_argument('--sample_rate', type=str, default=None, help="The sample rate value")
+parser.add_argument('--trace_format', choices=['ascii', 'binary', 'columnar'], default='ascii',
+                    help="Format of the trace written by aloha.py (--traceFormat)")
+parser.add_argument('--trace', type=str, default=None,
+                    help="Trace file (aloha.tr or aloha.trb), or the file prefix of a columnar trace (aloha)")
+parser.add_argument('--start', type=float, default=None, help="Columnar only: first second to read")
+parser.add_argument('--stop', type=float, default=None, help="Columnar only: second to stop reading at")
+parser.add_argument('--metrics', type=str, default=None,
+                    help="Plot the rows aloha.py --metricsWindow wrote (aloha.metrics) instead of a trace")
 args = parser.parse_args()
+if args.metrics is None and args.sample_rate is None:
+    parser.error("--sample_rate is required unless --metrics is given")
 
 delta = args.sample_rate 
 
-# Load the CSV file into a DataFrame
-df = pd.read_csv("aloha.tr", sep="\s+", names  = ["event", "time", "node", "delay", "size"])
+# Layout written by AlohaBinaryTraceWriter
+BINARY_HEADER = np.dtype([('magic', 'S8'), ('version', '<u4'), ('headerSize', '<u4'),
+                          ('recordSize', '<u4'), ('reserved', '<u4'), ('stepsPerSecond', '<i8')])
+BINARY_RECORD = np.dtype([('time', '<i8'), ('delay', '<i8'), ('node', '<u4'), ('size', '<u4'),
+                          ('event', 'u1'), ('padding', 'V7')])
+
+def read_binary(path):
+    header = np.fromfile(path, dtype=BINARY_HEADER, count=1)[0]
+    assert header['magic'] == b'ALOHATRC' and header['recordSize'] == BINARY_RECORD.itemsize
+    records = np.memmap(path, dtype=BINARY_RECORD, mode='r', offset=int(header['headerSize']))
+    steps = float(header['stepsPerSecond'])
+    receive = records['event'] == ord('r')
+    return pd.DataFrame({
+        'event': np.where(receive, 'r', '+'),
+        'time': records['time'] / steps,
+        'node': records['node'].astype(np.int64),
+        'delay': np.where(receive, records['delay'] / steps, np.nan),
+        'size': np.where(receive, records['size'], np.nan),
+    })
+
+# Layout written by AlohaColumnarTraceWriter, one file per column
+COLUMNAR_HEADER = np.dtype([('magic', 'S8'), ('version', '<u4'), ('headerSize', '<u4'),
+                            ('chunkRecords', '<u4'), ('valueSize', '<u4'), ('stepsPerSecond', '<i8')])
+COLUMNAR_TYPES = {'time': '<i8', 'delay': '<i8', 'node': '<u4', 'size': '<u4', 'event': 'u1'}
+
+def read_column_chunks(prefix, column):
+    path = prefix + '.' + column
+    header = np.fromfile(path, dtype=COLUMNAR_HEADER, count=1)[0]
+    assert header['magic'] == b'ALOHACOL'
+    values = np.dtype(COLUMNAR_TYPES[column])
+    assert header['valueSize'] == values.itemsize
+    chunk = np.dtype([('values', values, (int(header['chunkRecords']),)), ('count', '<u4'),
+                      ('reserved', '<u4'), ('minTime', '<i8'), ('maxTime', '<i8')])
+    return header, np.memmap(path, dtype=chunk, mode='r', offset=int(header['headerSize']))
+
+def read_columnar(prefix, columns, start=None, stop=None):
+    """Reads only the given columns, and only the chunks overlapping [start, stop) seconds."""
+    header, time_chunks = read_column_chunks(prefix, 'time')
+    steps = float(header['stepsPerSecond'])
+    # the footers alone pick the chunks, so the rest of the time column is never paged in
+    selected = np.ones(len(time_chunks), dtype=bool)
+    if start is not None:
+        selected &= time_chunks['maxTime'] >= int(start * steps)
+    if stop is not None:
+        selected &= time_chunks['minTime'] < int(stop * steps)
+    chunks = np.flatnonzero(selected)
+    counts = time_chunks['count'][chunks]
+
+    def decode(chunks_of_column):
+        return np.concatenate([chunks_of_column[k]['values'][:n] for k, n in zip(chunks, counts)]
+                              or [np.zeros(0, chunks_of_column.dtype['values'].base)])
+
+    time = decode(time_chunks)
+    keep = np.ones(len(time), dtype=bool)
+    if start is not None:
+        keep &= time >= int(start * steps)
+    if stop is not None:
+        keep &= time < int(stop * steps)
+    result = {}
+    for column in columns:
+        values = time if column == 'time' else decode(read_column_chunks(prefix, column)[1])
+        result[column] = values[keep]
+    return result, steps
+
+def read_columnar_trace(prefix, start, stop):
+    columns, steps = read_columnar(prefix, ['time', 'delay', 'node', 'size', 'event'], start, stop)
+    receive = columns['event'] == ord('r')
+    return pd.DataFrame({
+        'event': np.where(receive, 'r', '+'),
+        'time': columns['time'] / steps,
+        'node': columns['node'].astype(np.int64),
+        'delay': np.where(receive, columns['delay'] / steps, np.nan),
+        'size': np.where(receive, columns['size'], np.nan),
+    })
+
+# The simulation already computed every window: just plot the rows
+if args.metrics is not None:
+    metrics = pd.read_csv(args.metrics, sep="\s+")
+    metrics['time'] = pd.to_datetime(metrics['time'], unit='s', origin='unix')
+    metrics.set_index('time', inplace=True)
+    labels = ['Throughput (Mbps)', 'Average delay', 'Jain\'s Fairness Index', 'Average buffer size']
+    fig, axs = plt.subplots(4, 1, figsize=(12, 4 * (4)), sharex=False)
+    for ax, column, label in zip(axs, ['throughput', 'delay', 'fairness', 'buffer'], labels):
+        ax.plot(metrics[column], color='black')
+        ax.set_xlabel('Time')
+        ax.set_ylabel(label)
+        ax.grid(True)
+    plt.tight_layout()
+    plt.savefig('plot.png', format='png')
+    sys.exit(0)
+
+# Load the trace into a DataFrame
+if args.trace_format == 'binary':
+    df = read_binary(args.trace or "aloha.trb")
+elif args.trace_format == 'columnar':
+    df = read_columnar_trace(args.trace or "aloha", args.start, args.stop)
+else:
+    df = pd.read_csv(args.trace or "aloha.tr", sep="\s+", names  = ["event", "time", "node", "delay", "size"])
 
 # Assume 'time' is in seconds, convert it to a datetime format using an arbitrary start time
 df['time'] = pd.to_datetime(df['time'], unit='s', origin='unix')
@@ -5,6 +5,8 @@
 #include "ns3/wireless-channel.h"
 #include "ns3/wireless-net_device.h"
 
+#include <algorithm>
+
 
 namespace ns3 {
 
@@ -82,13 +84,25 @@ WirelessHelper::AssignStreams (NetDeviceContainer c, int64_t stream)
 {
 	int64_t currentStream = stream;
 	Ptr<NetDevice> netDevice;
+	std::vector< Ptr<WirelessChannel> > channels;
 	for (NetDeviceContainer::Iterator i = c.Begin (); i != c.End (); ++i) {
 		netDevice = (*i);
 		Ptr<WirelessNetDevice> wirelessDevice = DynamicCast<WirelessNetDevice> (netDevice);
 		if (wirelessDevice) {
 			currentStream += wirelessDevice->AssignStreams (currentStream);
+
+			// channels are shared, so only assign each one once, in the
+			// order they are first seen
+			auto channel = wirelessDevice->GetPhy()->GetChannel();
+			if (std::find(channels.begin(), channels.end(), channel) == channels.end()) {
+				channels.push_back(channel);
+			}
 		}
 	}
+
+	for (auto channel : channels) {
+		currentStream += channel->AssignStreams (currentStream);
+	}
 	return (currentStream - stream);
 }
 
@@ -1,5 +1,6 @@
 #include "ns3/node.h"
 #include "ns3/assert.h"
+#include "ns3/abort.h"
 #include "ns3/net-device.h"
 #include "ns3/log.h"
 #include "ns3/pointer.h"
@@ -10,6 +11,10 @@
 #include <ns3/data-rate.h>
 #include "ns3/boolean.h"
 #include "ns3/wireless-channel.h"
+#include "ns3/wireless-range-filter.h"
+
+#include <algorithm>
+#include <cmath>
 
 namespace ns3 {
 
@@ -39,13 +44,34 @@ WirelessChannel::GetTypeId (void)
 							"Data rate of the channel",
 							DataRateValue( DataRate("10Mb/s") ), 
 							MakeDataRateAccessor (&WirelessChannel::m_bps),
-							MakeDataRateChecker ());
+							MakeDataRateChecker ())
+					.AddAttribute ("UseSpatialIndex",
+							"Only visit receivers in grid cells adjacent to the sender "
+							"while all nodes are stationary",
+							BooleanValue (false),
+							MakeBooleanAccessor (&WirelessChannel::m_useSpatialIndex),
+							MakeBooleanChecker ())
+					.AddAttribute ("CacheLinks",
+							"Precompute each sender's in-range receivers and propagation "
+							"delays while all nodes are stationary",
+							BooleanValue (false),
+							MakeBooleanAccessor (&WirelessChannel::m_cacheLinks),
+							MakeBooleanChecker ())
+					.AddAttribute ("PruneReceivers",
+							"Only schedule receptions at PHYs whose receive filter accepts "
+							"the frame; the rest record it as interference",
+							BooleanValue (false),
+							MakeBooleanAccessor (&WirelessChannel::m_pruneReceivers),
+							MakeBooleanChecker ());
 	return tid;
 }
 
 WirelessChannel::WirelessChannel ()
 {
-
+	m_topologyDirty = true;
+	m_stationary = false;
+	m_pruneReceivers = false;
+	m_cellSize = 0;
 }
 
 WirelessChannel::~WirelessChannel (void)
@@ -63,7 +89,20 @@ WirelessChannel::SetPropagationDelayModel (const Ptr<PropagationDelayModel> dela
 void
 WirelessChannel::Attach(Ptr<WirelessPhyUpcalls> phy)
 {
+	NS_ASSERT(m_indices.count(PeekPointer(phy)) == 0);
+	m_indices[PeekPointer(phy)] = m_attached.size();
 	m_attached.push_back (phy);
+	m_filterAddresses.push_back (Mac48Address::GetBroadcast());
+	m_promiscuous.push_back (true);
+	m_topologyDirty = true;
+}
+
+void
+WirelessChannel::SetReceiveFilter(Ptr<WirelessPhyUpcalls> phy, Mac48Address address, bool promiscuous)
+{
+	uint32_t index = GetIndex(phy);
+	m_filterAddresses[index] = address;
+	m_promiscuous[index] = promiscuous;
 }
 
 std::size_t
@@ -75,30 +114,33 @@ WirelessChannel::GetNDevices(void) const
 Ptr<NetDevice>
 WirelessChannel::GetDevice(std::size_t index) const
 {
-	std::size_t j = 0;
-	for (auto iter = m_attached.begin (); iter != m_attached.end (); ++iter)
+	if (index < m_attached.size())
 	{
-		if (j == index)
-		{
-			return (*iter)->GetDevice();
-		}
-		j++;
+		return m_attached[index]->GetDevice();
 	}
 
 	NS_FATAL_ERROR ("Unable to get device");
 	return 0;
 }
 
+uint32_t
+WirelessChannel::GetIndex(Ptr<WirelessPhyUpcalls> phy) const
+{
+	auto found = m_indices.find(PeekPointer(phy));
+	NS_ASSERT_MSG(found != m_indices.end(), "PHY is not attached to this channel");
+	return found->second;
+}
+
 void
-WirelessChannel::StartReceive(Ptr<WirelessPhyUpcalls> receiver, Ptr<const TransmissionVector> rxVector)
+WirelessChannel::StartReceive(Ptr<WirelessPhyUpcalls> receiver, Ptr<const TransmissionVector> rxVector, uint32_t handle)
 {
-	receiver->StartReceive(rxVector);
+	receiver->StartReceive(rxVector, handle);
 }
 
 void
-WirelessChannel::FinishReceive(Ptr<WirelessPhyUpcalls> receiver, Ptr<const TransmissionVector> rxVector)
+WirelessChannel::FinishReceive(Ptr<WirelessPhyUpcalls> receiver, Ptr<const TransmissionVector> rxVector, uint32_t handle)
 {
-	receiver->FinishReceive(rxVector);
+	receiver->FinishReceive(rxVector, handle);
 }
 
 void
@@ -114,77 +156,297 @@ WirelessChannel::FinishTransmit(Ptr<WirelessPhyUpcalls> sender, Ptr<const Transm
 }
 
 void
-WirelessChannel::SendTo(Ptr<WirelessPhyUpcalls> sender,
-						Ptr<WirelessPhyUpcalls> receiver,
-						Ptr<const TransmissionVector> txVector)
-{	
-
-	Ptr<MobilityModel> senderMobility = sender->GetMobility();
-	Ptr<MobilityModel> receiverMobility = receiver->GetMobility();
+WirelessChannel::ScheduleReception(uint32_t sender,
+								uint32_t receiver,
+								Time delay,
+								Ptr<const TransmissionVector> txVector)
+{
+	if (m_pruneReceivers && !m_promiscuous[receiver])
+	{
+		Mac48Address destination = txVector->GetDestination();
+		if (destination != m_filterAddresses[receiver] && !destination.IsBroadcast())
+		{
+			Time start = Simulator::Now() + delay;
+			m_attached[receiver]->AddInterference(start, start + txVector->GetDuration());
+			return;
+		}
+	}
 
-	Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
 	Time duration = txVector->GetDuration();
+	auto dstNode = m_nodeIds[receiver];
 
-	Ptr<TransmissionVector> rxVector = Create<TransmissionVector>(
-		txVector->GetPacket(),
-		txVector->GetDevice(),
-		txVector->GetMobility(),
-		txVector->GetDuration(),
-		txVector->ShouldBeCorrupted()
-	);
+	// Every receiver shares the transmitted vector and its packet; the PHY
+	// only copies the packet once a reception is handed up to the MAC.
+	uint32_t handle = m_attached[receiver]->Reserve();
+
+	Simulator::ScheduleWithContext (
+		dstNode,
+		delay,
+		&WirelessChannel::StartReceive,
+		this,
+		m_attached[receiver],
+		txVector,
+		handle);
+
+	Simulator::ScheduleWithContext (
+		dstNode,
+		duration + delay,
+		&WirelessChannel::FinishReceive,
+		this,
+		m_attached[receiver],
+		txVector,
+		handle);
+}
+
+void
+WirelessChannel::SendTo(uint32_t sender,
+						uint32_t receiver,
+						Ptr<const TransmissionVector> txVector)
+{	
+
+	Ptr<MobilityModel> senderMobility = m_attached[sender]->GetMobility();
+	Ptr<MobilityModel> receiverMobility = m_attached[receiver]->GetMobility();
 
 	NS_ASSERT(m_range > 0);
 	NS_LOG_DEBUG("range= " << senderMobility->GetDistanceFrom(receiverMobility));
 
 	if(senderMobility->GetDistanceFrom(receiverMobility) <= m_range)
 	{
-		auto dstNode = receiver->GetDevice()->GetNode()->GetId();
-		
-		Simulator::ScheduleWithContext (
-			dstNode,
-			delay,
-			&WirelessChannel::StartReceive,
-			this,
-			receiver,
-			rxVector);
+		Time delay = m_delay->GetDelay (senderMobility, receiverMobility);
+		ScheduleReception(sender, receiver, delay, txVector);
+	}
+}
 
-		Simulator::ScheduleWithContext (
-			dstNode,
-			duration + delay,
-			&WirelessChannel::FinishReceive,
-			this,
-			receiver,
-			rxVector);
+Time
+WirelessChannel::GetDelay(uint32_t sender, uint32_t receiver) const
+{
+	return m_delay->GetDelay(m_mobility[sender], m_mobility[receiver]);
+}
+
+void
+WirelessChannel::GetNeighbors(uint32_t i, std::vector<uint32_t> &neighbors)
+{
+	NS_ASSERT(i < m_attached.size());
+	NS_ABORT_MSG_UNLESS(UpdateTopology(), "Neighbor sets are only defined for stationary nodes");
+	GetReceivers(i, neighbors);
+}
+
+Time
+WirelessChannel::GetPropagationDelay(uint32_t sender, uint32_t receiver)
+{
+	NS_ASSERT(sender < m_attached.size() && receiver < m_attached.size());
+	NS_ABORT_MSG_UNLESS(UpdateTopology(), "Link delays are only cached for stationary nodes");
+	return GetDelay(sender, receiver);
+}
+
+Ptr<WirelessPhyUpcalls>
+WirelessChannel::GetPhy(uint32_t index) const
+{
+	return m_attached[index];
+}
+
+uint32_t
+WirelessChannel::GetNodeId(uint32_t index) const
+{
+	return m_nodeIds[index];
+}
+
+bool
+WirelessChannel::InRange(uint32_t sender, uint32_t receiver) const
+{
+	double dx = m_x[sender] - m_x[receiver];
+	double dy = m_y[sender] - m_y[receiver];
+	double dz = m_z[sender] - m_z[receiver];
+	return std::sqrt(dx * dx + dy * dy + dz * dz) <= m_range;
+}
+
+void
+WirelessChannel::CourseChanged(Ptr<const MobilityModel> mobility)
+{
+	m_topologyDirty = true;
+}
+
+int64_t
+WirelessChannel::GetCell(double coordinate) const
+{
+	return static_cast<int64_t>(std::floor(coordinate / m_cellSize));
+}
+
+uint64_t
+WirelessChannel::GetCellKey(int64_t x, int64_t y, int64_t z)
+{
+	// 21 bits per axis, offset so that negative cells pack as well
+	const int64_t offset = 1 << 20;
+	const uint64_t mask = (1 << 21) - 1;
+	return (static_cast<uint64_t>(x + offset) & mask) << 42
+		| (static_cast<uint64_t>(y + offset) & mask) << 21
+		| (static_cast<uint64_t>(z + offset) & mask);
+}
+
+bool
+WirelessChannel::UpdateTopology(void)
+{
+	if (!m_topologyDirty && m_cellSize == m_range)
+	{
+		return m_stationary;
 	}
+
+	NS_ASSERT(m_range > 0);
+	std::size_t n = m_attached.size();
+	m_mobility.resize(n);
+	m_nodeIds.resize(n);
+	m_x.resize(n);
+	m_y.resize(n);
+	m_z.resize(n);
+	m_grid.clear();
+	m_links.assign(n, std::vector<Link>());
+	m_linksValid.assign(n, false);
+	m_cellSize = m_range;
+	m_topologyDirty = false;
+	m_stationary = true;
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		Ptr<MobilityModel> mobility = m_attached[i]->GetMobility();
+		NS_ASSERT(mobility);
+
+		if (m_tracked.insert(PeekPointer(mobility)).second)
+		{
+			mobility->TraceConnectWithoutContext(
+				"CourseChange",
+				MakeCallback(&WirelessChannel::CourseChanged, this));
+		}
+
+		// A moving node leaves its cell without firing CourseChange, so
+		// the cached positions, grid and link table are only trusted
+		// while everything stands still.
+		Vector velocity = mobility->GetVelocity();
+		if (velocity.x != 0 || velocity.y != 0 || velocity.z != 0)
+		{
+			m_stationary = false;
+		}
+
+		Vector position = mobility->GetPosition();
+		m_mobility[i] = mobility;
+		m_nodeIds[i] = m_attached[i]->GetNodeId();
+		m_x[i] = position.x;
+		m_y[i] = position.y;
+		m_z[i] = position.z;
+
+		if (m_useSpatialIndex)
+		{
+			uint64_t key = GetCellKey(GetCell(position.x), GetCell(position.y), GetCell(position.z));
+			m_grid[key].push_back(i);
+		}
+	}
+
+	NS_LOG_DEBUG("Rebuilt topology with " << m_grid.size() << " cells (stationary=" << m_stationary << ")");
+	return m_stationary;
 }
 
-Ptr<TransmissionVector> clone(Ptr<const TransmissionVector> txVector)
+void
+WirelessChannel::GetReceivers(uint32_t sender, std::vector<uint32_t> &receivers) const
 {
-	Ptr<Packet> packet = txVector->GetPacket();
-	
-	Ptr<TransmissionVector> clone = Create<TransmissionVector>(
-		Create<Packet>(*packet),
-		txVector->GetDevice(),
-		txVector->GetMobility(),
-		txVector->GetDuration(),
-		txVector->ShouldBeCorrupted()
-		);
+	receivers.clear();
 
-	return clone;
+	if (!m_useSpatialIndex)
+	{
+		// one vectorised pass over the whole position cache
+		FindInRange(m_x.data(), m_y.data(), m_z.data(), m_attached.size(),
+			m_x[sender], m_y[sender], m_z[sender], m_range, receivers);
+		receivers.erase(std::remove(receivers.begin(), receivers.end(), sender), receivers.end());
+		return;
+	}
+
+	// Gather the 27 surrounding cells and restore attach order so that
+	// events are scheduled exactly as the exhaustive loop would.
+	int64_t cx = GetCell(m_x[sender]);
+	int64_t cy = GetCell(m_y[sender]);
+	int64_t cz = GetCell(m_z[sender]);
+
+	for (int64_t dx = -1; dx <= 1; dx++)
+	{
+		for (int64_t dy = -1; dy <= 1; dy++)
+		{
+			for (int64_t dz = -1; dz <= 1; dz++)
+			{
+				auto cell = m_grid.find(GetCellKey(cx + dx, cy + dy, cz + dz));
+				if (cell != m_grid.end())
+				{
+					for (uint32_t i : cell->second)
+					{
+						if (i != sender && InRange(sender, i))
+						{
+							receivers.push_back(i);
+						}
+					}
+				}
+			}
+		}
+	}
+
+	std::sort(receivers.begin(), receivers.end());
+}
+
+const std::vector<WirelessChannel::Link> &
+WirelessChannel::GetLinks(uint32_t sender)
+{
+	std::vector<Link> &links = m_links[sender];
+	if (m_linksValid[sender])
+	{
+		return links;
+	}
+
+	GetReceivers(sender, m_receivers);
+	for (uint32_t receiver : m_receivers)
+	{
+		links.push_back(Link {
+			receiver,
+			GetDelay(sender, receiver)
+		});
+	}
+
+	m_linksValid[sender] = true;
+	NS_LOG_DEBUG("Cached " << links.size() << " links for node " << m_nodeIds[sender]);
+	return links;
 }
 
 void
 WirelessChannel::Send(Ptr<WirelessPhyUpcalls> sender, Ptr<const TransmissionVector> txVector)
 {
-	for (auto i = m_attached.begin (); i != m_attached.end (); ++i)
+	uint32_t index = GetIndex(sender);
+	bool stationary = UpdateTopology();
+	auto senderNode = m_nodeIds[index];
+
+	// Only a deterministic delay model can be frozen into the link table.
+	if (stationary && m_cacheLinks && DynamicCast<ConstantSpeedPropagationDelayModel>(m_delay))
 	{
-		if (sender != *i)
+		const std::vector<Link> &links = GetLinks(index);
+		for (auto i = links.begin (); i != links.end (); ++i)
 		{
-			SendTo(sender, *i, clone(txVector));
+			ScheduleReception(index, i->receiver, i->delay, txVector);
+		}
+	}
+	else if (stationary)
+	{
+		// Positions in the cache are current, so range checks need no
+		// calls into the mobility models.
+		GetReceivers(index, m_receivers);
+		for (uint32_t receiver : m_receivers)
+		{
+			ScheduleReception(index, receiver, GetDelay(index, receiver), txVector);
+		}
+	}
+	else
+	{
+		for (uint32_t receiver = 0; receiver < m_attached.size(); receiver++)
+		{
+			if (receiver != index)
+			{
+				SendTo(index, receiver, txVector);
+			}
 		}
 	}
-
-	auto senderNode = sender->GetDevice()->GetNode()->GetId();
 
 	NS_LOG_DEBUG("Transmission (" << txVector->GetPacket()->GetSize() << ") from " << senderNode << " until " << Simulator::Now() + txVector->GetDuration());
 	Simulator::ScheduleWithContext (
@@ -207,7 +469,9 @@ WirelessChannel::Send(Ptr<WirelessPhyUpcalls> sender, Ptr<const TransmissionVect
 int64_t
 WirelessChannel::AssignStreams (int64_t stream)
 {
-	NS_FATAL_ERROR("Not implemented");
+	NS_LOG_FUNCTION (this << stream);
+	NS_ASSERT(m_delay);
+	return m_delay->AssignStreams(stream);
 }
 
 const DataRate 
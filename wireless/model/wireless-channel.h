@@ -1,7 +1,9 @@
 #ifndef ALOHA_WIRELESS_CHANNEL_H
 #define ALOHA_WIRELESS_CHANNEL_H
 
-#include <list>
+#include <set>
+#include <unordered_map>
+#include <vector>
 #include "ns3/channel.h"
 #include "ns3/log.h"
 #include "ns3/ptr.h"
@@ -11,6 +13,7 @@
 #include "ns3/wireless-phy-upcalls.h"
 #include "ns3/wireless-transmission-vector.h"
 #include "ns3/data-rate.h"
+#include "ns3/vector.h"
 
 namespace ns3 {
 
@@ -32,26 +35,107 @@ public:
 
 	void Send (Ptr<WirelessPhyUpcalls> sender, Ptr<const TransmissionVector> txVector);
 
+	/*
+	 * With PruneReceivers, a frame is only delivered to PHYs it is
+	 * addressed to and to promiscuous ones; every other PHY in range is
+	 * told about it as interference. PHYs are promiscuous until set.
+	 */
+	void SetReceiveFilter (Ptr<WirelessPhyUpcalls> phy, Mac48Address address, bool promiscuous);
+
+	/*
+	 * Devices in range of device i, in attach order, and the propagation
+	 * delay of a link; indices are those of GetDevice. Both require every
+	 * node to be stationary.
+	 */
+	void GetNeighbors (uint32_t i, std::vector<uint32_t> &neighbors);
+	Time GetPropagationDelay (uint32_t sender, uint32_t receiver);
+
     const DataRate GetDataRate();
 
 protected:
 
-	void StartReceive(Ptr<WirelessPhyUpcalls> receiver, Ptr<const TransmissionVector> rxVector);
-	void FinishReceive(Ptr<WirelessPhyUpcalls> receiver, Ptr<const TransmissionVector> rxVector);
+	void StartReceive(Ptr<WirelessPhyUpcalls> receiver, Ptr<const TransmissionVector> rxVector, uint32_t handle);
+	void FinishReceive(Ptr<WirelessPhyUpcalls> receiver, Ptr<const TransmissionVector> rxVector, uint32_t handle);
 
 	void StartTransmit(Ptr<WirelessPhyUpcalls> sender, Ptr<const TransmissionVector> txVector);
 	void FinishTransmit(Ptr<WirelessPhyUpcalls> sender, Ptr<const TransmissionVector> txVector);
 
-	void SendTo(Ptr<WirelessPhyUpcalls> sender,
-				Ptr<WirelessPhyUpcalls> receiver,
+	void SendTo(uint32_t sender,
+				uint32_t receiver,
+				Ptr<const TransmissionVector> txVector);
+
+	virtual void ScheduleReception(uint32_t sender,
+				uint32_t receiver,
+				Time delay,
 				Ptr<const TransmissionVector> txVector);
 
+	/*
+	 * Index-based access for subclasses. Node ids, positions and delays
+	 * come from the cache and are valid after UpdateTopology; receivers
+	 * and delays additionally require it to have returned true.
+	 */
+	bool UpdateTopology(void);
+	void GetReceivers(uint32_t sender, std::vector<uint32_t> &receivers) const;
+	Time GetDelay(uint32_t sender, uint32_t receiver) const;
+	uint32_t GetIndex(Ptr<WirelessPhyUpcalls> phy) const;
+	Ptr<WirelessPhyUpcalls> GetPhy(uint32_t index) const;
+	uint32_t GetNodeId(uint32_t index) const;
+
 private:
 
+	/*
+	 * A receiver in range of some sender, with its propagation delay
+	 * resolved once.
+	 */
+	struct Link
+	{
+		uint32_t receiver;
+		Time delay;
+	};
+
+	/*
+	 * Positions, the grid and the link table are rebuilt lazily after a
+	 * MobilityModel CourseChange and are only used while every attached
+	 * node is stationary; otherwise Send asks the mobility models directly.
+	 *
+	 * The grid has cells of TransmissionRange metres, so a receiver in
+	 * range of a sender is always in the sender's cell or one of its 26
+	 * neighbours.
+	 */
+	void CourseChanged(Ptr<const MobilityModel> mobility);
+	const std::vector<Link> &GetLinks(uint32_t sender);
+	bool InRange(uint32_t sender, uint32_t receiver) const;
+	int64_t GetCell(double coordinate) const;
+	static uint64_t GetCellKey(int64_t x, int64_t y, int64_t z);
+
 	Ptr<PropagationDelayModel> m_delay;
-	std::list< Ptr<WirelessPhyUpcalls> > m_attached;
+	std::vector< Ptr<WirelessPhyUpcalls> > m_attached;
+	std::unordered_map<const WirelessPhyUpcalls *, uint32_t> m_indices;
 	double m_range;
 	DataRate m_bps;
+
+	bool m_useSpatialIndex;
+	bool m_cacheLinks;
+	bool m_pruneReceivers;
+	bool m_topologyDirty;
+	bool m_stationary;
+	double m_cellSize;
+
+	/* structure-of-arrays cache, indexed like m_attached */
+	std::vector< Ptr<MobilityModel> > m_mobility;
+	std::vector<uint32_t> m_nodeIds;
+	std::vector<double> m_x;
+	std::vector<double> m_y;
+	std::vector<double> m_z;
+
+	std::unordered_map< uint64_t, std::vector<uint32_t> > m_grid;
+	std::vector< std::vector<Link> > m_links;
+	std::vector<bool> m_linksValid;
+	std::set<const MobilityModel *> m_tracked;
+	std::vector<uint32_t> m_receivers;
+
+	std::vector<Mac48Address> m_filterAddresses;
+	std::vector<bool> m_promiscuous;
 };
 
 } // namespace ns3
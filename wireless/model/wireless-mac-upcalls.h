@@ -9,28 +9,44 @@
 
 namespace ns3 {
 
+/*
+ * What a PHY calls on its MAC. Carrier sense and transmit completion
+ * default to doing nothing.
+ */
 class WirelessMacUpcalls : public SimpleRefCount<WirelessMacUpcalls>{
 public:
 
-    typedef Callback<void, Ptr<Packet>> RxMacCallback;
-    typedef Callback<void> CarrierSenseCallback;
-    typedef Callback<void> FinishTransmitCallback;
-
-    WirelessMacUpcalls(RxMacCallback rxCallback, CarrierSenseCallback startSenseCallback, CarrierSenseCallback endSenseCallback, FinishTransmitCallback finishTransmitCallback);
     virtual ~WirelessMacUpcalls();
 
-    void Receive(Ptr<Packet> packet);
-    void StartCarrierSense(void);
-    void EndCarrierSense(void);
-    void FinishTransmit(void);
+    virtual void Receive(Ptr<Packet> packet) = 0;
+    virtual void StartCarrierSense(void);
+    virtual void EndCarrierSense(void);
+    virtual void FinishTransmit(void);
+};
+
+/*
+ * Forwards the upcalls to the MAC's own methods of the same name. The MAC
+ * owns the adapter, so the raw pointer stays valid for its lifetime; a
+ * MAC whose upcall methods are not public befriends the adapter.
+ */
+template <typename T>
+class WirelessMacUpcallsImpl final : public WirelessMacUpcalls {
+public:
+
+    WirelessMacUpcallsImpl(T *mac)
+    : m_mac(mac)
+    {
+    }
+
+    void Receive(Ptr<Packet> packet) override { m_mac->Receive(packet); }
+    void StartCarrierSense(void) override { m_mac->StartCarrierSense(); }
+    void EndCarrierSense(void) override { m_mac->EndCarrierSense(); }
+    void FinishTransmit(void) override { m_mac->FinishTransmit(); }
 
 private:
-    RxMacCallback rxCallback;
-    CarrierSenseCallback startSenseCallback;
-    CarrierSenseCallback endSenseCallback;
-    FinishTransmitCallback finishTransmitCallback;
+    T *m_mac;
 };
 
 } /* namespace ns3 */
 
-#endif /* WIRELESS_MAC_UPCALLS_H */
\ No newline at end of file
+#endif /* WIRELESS_MAC_UPCALLS_H */
@@ -24,6 +24,32 @@ NS_LOG_COMPONENT_DEFINE("WirelessNetDevice");
 
 NS_OBJECT_ENSURE_REGISTERED(WirelessNetDevice);
 
+/*
+ * The device has no use for carrier sense, so it only takes receptions
+ * and the end of its own transmissions from the PHY.
+ */
+class WirelessNetDeviceUpcalls : public WirelessMacUpcalls
+{
+  public:
+    WirelessNetDeviceUpcalls(WirelessNetDevice* device)
+        : m_device(device)
+    {
+    }
+
+    void Receive(Ptr<Packet> packet) override
+    {
+        m_device->Receive(packet);
+    }
+
+    void FinishTransmit(void) override
+    {
+        m_device->TransmitCompleteEvent();
+    }
+
+  private:
+    WirelessNetDevice* m_device;
+};
+
 TypeId
 WirelessNetDevice::GetTypeId()
 {
@@ -57,10 +83,7 @@ WirelessNetDevice::WirelessNetDevice()
     m_txMachineState = READY;
     m_phy = nullptr;
     m_queue = CreateObject<DropTailQueue<Packet>>();
-    m_macUpcalls = Create<WirelessMacUpcalls> ( MakeCallback  (&WirelessNetDevice::Receive, this),
-                                                MakeNullCallback<void> (),
-                                                MakeNullCallback<void> (),
-                                                MakeCallback (&WirelessNetDevice::TransmitCompleteEvent, this));
+    m_macUpcalls = Create<WirelessNetDeviceUpcalls>(this);
 }
 
 WirelessNetDevice::~WirelessNetDevice()
@@ -582,7 +605,8 @@ WirelessNetDevice::SupportsSendFrom() const
 int64_t
 WirelessNetDevice::AssignStreams(int64_t stream)
 {
-    return 0;
+    NS_ASSERT(m_phy);
+    return m_phy->AssignStreams(stream);
 }
 
 void
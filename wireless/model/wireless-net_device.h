@@ -23,6 +23,7 @@ class WirelessPhy;
 class WirelessChannel;
 class ErrorModel;
 class WirelessMacUpcalls;
+class WirelessNetDeviceUpcalls;
 
 /**
  * \defgroup csma CSMA Network Device
@@ -329,6 +330,8 @@ class WirelessNetDevice : public NetDevice
      */
     void TransmitCompleteEvent();
 
+    friend class WirelessNetDeviceUpcalls;
+
     /**
      * Cause the Transmitter to Become Ready to Send Another Packet.
      *
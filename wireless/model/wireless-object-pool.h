@@ -0,0 +1,115 @@
+#ifndef WIRELESS_OBJECT_POOL_H
+#define WIRELESS_OBJECT_POOL_H
+
+#include <stdint.h>
+#include <cstddef>
+#include <new>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Free list of fixed-size blocks for a short-lived, frequently allocated
+ * type T. A class opts in by forwarding its operator new and delete here;
+ * blocks of any other size (a derived class) go to the global heap.
+ *
+ * The pool is per process and not thread safe, which matches the
+ * sequential and MPI-distributed simulators. Freed blocks are kept for
+ * reuse until Trim is called.
+ */
+template <typename T>
+class WirelessObjectPool
+{
+public:
+
+	struct Stats
+	{
+		uint64_t allocated;	/* blocks taken from the heap */
+		uint64_t reused;	/* allocations served from the free list */
+		uint64_t live;		/* objects currently in use */
+		uint64_t peak;		/* largest value of live */
+	};
+
+	static void *Allocate(std::size_t size)
+	{
+		if (size != sizeof(T))
+		{
+			return ::operator new(size);
+		}
+
+		Instance &pool = Get();
+		void *block;
+		if (!pool.free.empty())
+		{
+			block = pool.free.back();
+			pool.free.pop_back();
+			pool.stats.reused++;
+		}
+		else
+		{
+			block = ::operator new(sizeof(T));
+			pool.stats.allocated++;
+		}
+
+		if (++pool.stats.live > pool.stats.peak)
+		{
+			pool.stats.peak = pool.stats.live;
+		}
+		return block;
+	}
+
+	static void Release(void *block, std::size_t size)
+	{
+		if (block == 0)
+		{
+			return;
+		}
+
+		if (size != sizeof(T))
+		{
+			::operator delete(block);
+			return;
+		}
+
+		Instance &pool = Get();
+		pool.stats.live--;
+		pool.free.push_back(block);
+	}
+
+	static Stats GetStats(void)
+	{
+		return Get().stats;
+	}
+
+	/* Returns every free block to the heap. */
+	static void Trim(void)
+	{
+		Instance &pool = Get();
+		for (void *block : pool.free)
+		{
+			::operator delete(block);
+		}
+		pool.free.clear();
+		pool.free.shrink_to_fit();
+	}
+
+private:
+
+	struct Instance
+	{
+		std::vector<void *> free;
+		Stats stats {0, 0, 0, 0};
+	};
+
+	static Instance &Get(void)
+	{
+		// Never destroyed, so objects released during static destruction
+		// still find their pool.
+		static Instance *instance = new Instance;
+		return *instance;
+	}
+};
+
+} /* namespace ns3 */
+
+#endif /* WIRELESS_OBJECT_POOL_H */
@@ -3,45 +3,72 @@
 
 #include <ns3/simple-ref-count.h>
 #include <ns3/net-device.h>
+#include <ns3/node.h>
 
 #include "ns3/wireless-transmission-vector.h"
 
 namespace ns3 {
 
+/*
+ * What the channel calls on an attached PHY.
+ */
 class WirelessPhyUpcalls : public SimpleRefCount<WirelessPhyUpcalls> {
 public:
 
-	typedef Callback<void, Ptr<const TransmissionVector> > TxCallback;
-	typedef Callback<void, Ptr<const TransmissionVector> > RxCallback;
-	typedef Callback< Ptr<NetDevice> > GetDeviceCallback;
-	typedef Callback< Ptr<MobilityModel> > GetMobilityCallback;
+	WirelessPhyUpcalls();
+	virtual ~WirelessPhyUpcalls();
 
+	virtual void StartTransmit(Ptr<const TransmissionVector> txVector) = 0;
+	virtual void FinishTransmit(Ptr<const TransmissionVector> txVector) = 0;
 
-	WirelessPhyUpcalls(
-			TxCallback startTransmit,
-			TxCallback finishTransmit,
-			RxCallback startReceive,
-			RxCallback finishReceive,
-			GetDeviceCallback getDevice,
-			GetMobilityCallback getMobility
-			);
+	/*
+	 * Reserve returns a handle to a reception slot in the PHY; the same
+	 * handle is passed with the rx vector to StartReceive and FinishReceive.
+	 */
+	virtual uint32_t Reserve(void) = 0;
+	virtual void StartReceive(Ptr<const TransmissionVector> rxVector, uint32_t handle) = 0;
+	virtual void FinishReceive(Ptr<const TransmissionVector> rxVector, uint32_t handle) = 0;
 
-	virtual ~WirelessPhyUpcalls();
+	/*
+	 * A frame the PHY will not be given, arriving between start and end,
+	 * that still collides with anything it does receive in that interval.
+	 */
+	virtual void AddInterference(Time start, Time end) = 0;
+	virtual Ptr<NetDevice> GetDevice(void) const = 0;
+	virtual Ptr<MobilityModel> GetMobility(void) const = 0;
+
+	/* Id of the device's node, looked up once on first use. */
+	uint32_t GetNodeId(void) const;
+
+private:
+	mutable uint32_t m_nodeId;
+	mutable bool m_hasNodeId;
+};
+
+/*
+ * Forwards the upcalls to the PHY's own methods of the same name. The PHY
+ * owns the adapter, so the raw pointer stays valid for its lifetime.
+ */
+template <typename T>
+class WirelessPhyUpcallsImpl final : public WirelessPhyUpcalls {
+public:
+
+	WirelessPhyUpcallsImpl(T *phy)
+	: m_phy(phy)
+	{
+	}
 
-	void StartTransmit(Ptr<const TransmissionVector> txVector);
-	void FinishTransmit(Ptr<const TransmissionVector> txVector);
-	void StartReceive(Ptr<const TransmissionVector> rxVector);
-	void FinishReceive(Ptr<const TransmissionVector> rxVector);
-	Ptr<NetDevice> GetDevice(void) const;
-	Ptr<MobilityModel> GetMobility(void) const;
+	void StartTransmit(Ptr<const TransmissionVector> txVector) override { m_phy->StartTransmit(txVector); }
+	void FinishTransmit(Ptr<const TransmissionVector> txVector) override { m_phy->FinishTransmit(txVector); }
+	uint32_t Reserve(void) override { return m_phy->Reserve(); }
+	void StartReceive(Ptr<const TransmissionVector> rxVector, uint32_t handle) override { m_phy->StartReceive(rxVector, handle); }
+	void FinishReceive(Ptr<const TransmissionVector> rxVector, uint32_t handle) override { m_phy->FinishReceive(rxVector, handle); }
+	void AddInterference(Time start, Time end) override { m_phy->AddInterference(start, end); }
+	Ptr<NetDevice> GetDevice(void) const override { return m_phy->GetDevice(); }
+	Ptr<MobilityModel> GetMobility(void) const override { return m_phy->GetMobility(); }
 
 private:
-	TxCallback startTransmit;
-	TxCallback finishTransmit;
-	RxCallback startReceive;
-	RxCallback finishReceive;
-	GetDeviceCallback getDevice;
-	GetMobilityCallback getMobility;
+	T *m_phy;
 };
 
 } /* namespace ns3 */
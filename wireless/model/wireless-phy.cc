@@ -4,9 +4,16 @@
 #include <ns3/boolean.h>
 #include <ns3/double.h>
 
+#include <algorithm>
+#include <cmath>
+#include <map>
+
 #define _1MBPS 1000000.0
 #define _10MBPS 10000000.0
 
+/* frames larger than this are timed directly instead of through the table */
+#define MAX_AIRTIME_ENTRIES 65536
+
 namespace ns3 {
 
 NS_LOG_COMPONENT_DEFINE ("WirelessPhy");
@@ -18,6 +25,13 @@ enum {
     IDLE
 };
 
+/* heap order for m_interference: the interval ending first on top */
+static bool
+EndsLater(const std::pair<Time, Time> &a, const std::pair<Time, Time> &b)
+{
+    return a.second > b.second;
+}
+
 TypeId
 WirelessPhy::GetTypeId (void)
 {
@@ -27,10 +41,17 @@ WirelessPhy::GetTypeId (void)
             .SetGroupName("Wireless")
             .AddConstructor<WirelessPhy>()
             .AddAttribute ("PacketErrorRate", 
-                "The probability that a packet is corrupted in transmission",
+                "The probability that a received frame is lost, independent of its size",
                 DoubleValue(0.0), 
-                MakeDoubleAccessor (&WirelessPhy::m_per),
-                MakeDoubleChecker<double>(0.0))
+                MakeDoubleAccessor (&WirelessPhy::SetPacketErrorRate,
+                                    &WirelessPhy::GetPacketErrorRate),
+                MakeDoubleChecker<double>(0.0, 1.0))
+            .AddAttribute ("BitErrorRate",
+                "The probability that each bit of a received frame is in error",
+                DoubleValue(0.0),
+                MakeDoubleAccessor (&WirelessPhy::SetBitErrorRate,
+                                    &WirelessPhy::GetBitErrorRate),
+                MakeDoubleChecker<double>(0.0, 1.0))
             .AddAttribute ("EnableCollisions",
                     "Whether collisions may occur",
                     BooleanValue (true),
@@ -43,21 +64,26 @@ WirelessPhy::GetTypeId (void)
 WirelessPhy::WirelessPhy (void)
 {
     m_channel = 0;
+    m_airtime = 0;
     m_device = 0;
     m_mobility = 0;
     m_macUpcalls = 0;
     m_sensing = false;
+    m_rng = CreateObject<UniformRandomVariable> ();
 
-    m_phyUpcalls = Create<WirelessPhyUpcalls>(               
-        MakeCallback (&WirelessPhy::StartTransmit, this),
-        MakeCallback (&WirelessPhy::FinishTransmit, this),
-        MakeCallback (&WirelessPhy::StartReceive, this),
-        MakeCallback (&WirelessPhy::FinishReceive, this),
-        MakeCallback (&WirelessPhy::GetDevice, this),
-        MakeCallback (&WirelessPhy::GetMobility, this)
-        );
+    m_phyUpcalls = Create< WirelessPhyUpcallsImpl<WirelessPhy> >(this);
 
     m_state = IDLE;
+    m_receiving = 0;
+    m_epoch = 0;
+
+    m_defaultLink.per = 0.0;
+    m_defaultLink.ber = 0.0;
+    UpdateHazard(m_defaultLink);
+    m_useErrorModel = false;
+    m_errorClock = -1.0;
+    m_hasFilter = false;
+    m_promiscuous = true;
 }
 
 WirelessPhy::~WirelessPhy (void){
@@ -69,6 +95,10 @@ WirelessPhy::SetChannel (Ptr<WirelessChannel> channel)
     NS_ASSERT(channel);
     m_channel = channel;
     channel->Attach(m_phyUpcalls);
+
+    if (m_hasFilter) {
+        channel->SetReceiveFilter(m_phyUpcalls, m_filterAddress, m_promiscuous);
+    }
 }
 
 Ptr<WirelessChannel> 
@@ -116,31 +146,61 @@ WirelessPhy::SetPhyUpcalls (Ptr<WirelessPhyUpcalls> upcalls)
     m_phyUpcalls = upcalls;
 }
 
+void
+WirelessPhy::SetReceiveFilter (Mac48Address address, bool promiscuous)
+{
+    m_hasFilter = true;
+    m_filterAddress = address;
+    m_promiscuous = promiscuous;
+
+    if (m_channel) {
+        m_channel->SetReceiveFilter(m_phyUpcalls, address, promiscuous);
+    }
+}
+
 bool
 WirelessPhy::Send (Ptr<Packet> pkt)
 {
-    NS_ASSERT(m_channel);
-    NS_LOG_DEBUG("Sending from Phy");
+    return Send(pkt, Mac48Address::GetBroadcast());
+}
+
+bool
+WirelessPhy::Send (Ptr<Packet> pkt, Mac48Address destination)
+{
+    return SendFrame(Encapsulate(pkt), destination);
+}
 
+Ptr<Packet>
+WirelessPhy::Encapsulate (Ptr<const Packet> pkt) const
+{
     auto copy = pkt->Copy();
 
     PlcpHeader phyHeader;
     copy->AddHeader(phyHeader);
+    return copy;
+}
 
-    // Corrupt packet randomly based on PER of the PHY. If a packet is corrupted
-    // it will not be successfully received by any receiver.
-	static Ptr<UniformRandomVariable> rng = CreateObject<UniformRandomVariable> ();
-	
-    //bool shouldBeCorrupted = (m_per > rng->GetValue(0.0, 1.0));
+bool
+WirelessPhy::SendFrame (Ptr<const Packet> frame, Mac48Address destination)
+{
+    NS_ASSERT(m_channel);
+    NS_ASSERT(frame->GetSize() >= PlcpHeader::SERIALIZED_SIZE);
+    NS_LOG_DEBUG("Sending from Phy");
+
+    Time duration = GetTransmissionTime(frame->GetSize() - PlcpHeader::SERIALIZED_SIZE);
+
+    // Losses are drawn per link at each receiver (see IsErrored), so the
+    // transmission itself always leaves intact.
     bool shouldBeCorrupted = false;
 
     NS_ASSERT(m_device);
     Ptr<TransmissionVector> txVector = Create<TransmissionVector> (
-        copy, 
+        frame, 
         m_device, 
         m_mobility,
-        GetPacketTime(copy),
-        shouldBeCorrupted
+        duration,
+        shouldBeCorrupted,
+        destination
         ); 
 
     NS_ASSERT(m_phyUpcalls);
@@ -148,19 +208,50 @@ WirelessPhy::Send (Ptr<Packet> pkt)
     return true;
 }
 
+int64_t
+WirelessPhy::AssignStreams (int64_t stream)
+{
+    m_rng->SetStream(stream);
+    return 1;
+}
+
+uint32_t
+WirelessPhy::Reserve (void)
+{
+    if (!m_free.empty()) {
+        uint32_t handle = m_free.back();
+        m_free.pop_back();
+        return handle;
+    }
+
+    m_units.emplace_back();
+    return m_units.size() - 1;
+}
+
 void
-WirelessPhy::StartReceive (Ptr<const TransmissionVector> rxVector)
+WirelessPhy::Release (uint32_t handle)
+{
+    m_units[handle] = TransmissionUnit();
+    m_free.push_back(handle);
+}
+
+void
+WirelessPhy::StartReceive (Ptr<const TransmissionVector> rxVector, uint32_t handle)
 {
     NS_LOG_DEBUG("Started Receiving rxVector");  
-    
-    m_transmissions.push_back(Create<TransmissionUnit>(rxVector));
+    NS_ASSERT(handle < m_units.size() && !m_units[handle].GetTransmissionVector());
 
-    if (m_enableCollisions) {
-        if((m_transmissions.size() > 1) || (m_state == TX)) {
-            for(auto unit : m_transmissions) {
-                unit->Corrupt();
-            }
-        }
+    bool collision = m_enableCollisions && ((m_receiving > 0) || (m_state == TX));
+    if (collision) {
+        m_epoch++;
+    }
+
+    m_units[handle] = TransmissionUnit(rxVector, m_epoch, Simulator::Now());
+    m_receiving++;
+    m_rxStarts.push_back(std::make_pair(Simulator::Now(), handle));
+
+    if (collision) {
+        m_units[handle].Corrupt();
     }
 
     if (m_state == IDLE) {
@@ -171,30 +262,83 @@ WirelessPhy::StartReceive (Ptr<const TransmissionVector> rxVector)
 }
 
 void
-WirelessPhy::FinishReceive(Ptr<const TransmissionVector> rxVector)
+WirelessPhy::FinishReceive(Ptr<const TransmissionVector> rxVector, uint32_t handle)
 {
     NS_LOG_DEBUG("Finished receiving rxVector");
-
-    for(auto unit : m_transmissions) {
-        if(unit->GetTransmissionVector() == rxVector) {
-            if(!m_enableCollisions || !unit->IsCorrupted()) {
-                PlcpHeader phyHeader;
-                unit->GetTransmissionVector()->GetPacket()->RemoveHeader(phyHeader);
-                m_macUpcalls->Receive(unit->GetTransmissionVector()->GetPacket());
-            }
-
-            m_transmissions.remove(unit);
+    NS_ASSERT(handle < m_units.size() && m_units[handle].GetTransmissionVector() == rxVector);
+
+    const TransmissionUnit &unit = m_units[handle];
+    bool corrupted = unit.IsCorrupted() || (unit.GetEpoch() != m_epoch)
+        || IsInterfered(unit.GetStart(), Simulator::Now());
+    Release(handle);
+    m_receiving--;
+
+    // A handle reused since has a later start, so the start tells a
+    // finished reception from the one now in its slot.
+    while (!m_rxStarts.empty()) {
+        const TransmissionUnit &front = m_units[m_rxStarts.front().second];
+        if (front.GetTransmissionVector() && front.GetStart() == m_rxStarts.front().first) {
             break;
         }
+        m_rxStarts.pop_front();
+    }
+
+    if((!m_enableCollisions || !corrupted) && !IsErrored(rxVector)) {
+        // rx vectors are shared by all receivers, so take a private
+        // (copy-on-write) packet before stripping the PLCP header
+        Ptr<Packet> packet = rxVector->GetPacket()->Copy();
+        PlcpHeader phyHeader;
+        packet->RemoveHeader(phyHeader);
+        m_macUpcalls->Receive(packet);
     }
 
-    if(m_transmissions.empty() && m_state == RX){
+    if(m_receiving == 0 && !m_interference.empty()) {
+        PurgeInterference();
+    }
+
+    if(m_receiving == 0 && m_state == RX){
         m_state = IDLE;
         m_macUpcalls->EndCarrierSense();
         m_sensing = false;
     }
 }
 
+void
+WirelessPhy::AddInterference(Time start, Time end)
+{
+    if (!m_enableCollisions) {
+        return;
+    }
+
+    PurgeInterference();
+    m_interference.push_back(std::make_pair(start, end));
+    std::push_heap(m_interference.begin(), m_interference.end(), EndsLater);
+}
+
+void
+WirelessPhy::PurgeInterference(void)
+{
+    // Intervals that ended before every reception still in progress can
+    // no longer overlap anything.
+    Time horizon = m_rxStarts.empty() ? Simulator::Now() : m_rxStarts.front().first;
+
+    while (!m_interference.empty() && m_interference.front().second <= horizon) {
+        std::pop_heap(m_interference.begin(), m_interference.end(), EndsLater);
+        m_interference.pop_back();
+    }
+}
+
+bool
+WirelessPhy::IsInterfered(Time start, Time end) const
+{
+    for (const auto &i : m_interference) {
+        if (i.first < end && i.second > start) {
+            return true;
+        }
+    }
+    return false;
+}
+
 void
 WirelessPhy::StartTransmit(Ptr<const TransmissionVector> txVector)
 {
@@ -203,10 +347,8 @@ WirelessPhy::StartTransmit(Ptr<const TransmissionVector> txVector)
 
     m_state = TX;
     
-    if (m_enableCollisions) {
-        for(auto unit : m_transmissions) {
-            unit->Corrupt();
-        }
+    if (m_enableCollisions && m_receiving > 0) {
+        m_epoch++;
     }
 }
 
@@ -215,7 +357,7 @@ WirelessPhy::FinishTransmit(Ptr<const TransmissionVector> txVector)
 {
     NS_LOG_DEBUG("Finish Transmission");
 
-    if (!m_transmissions.empty())
+    if (m_receiving > 0)
         m_state = RX;
     else
         m_state = IDLE;
@@ -242,23 +384,153 @@ WirelessPhy::IsReceiving(void)
 }
 
 Time
-WirelessPhy::GetPacketTime(Ptr<const Packet> packet)
+WirelessPhy::GetPacketTime(uint32_t size) const
 {   
-    Time phyTime = Seconds(24 * 8.0 / _1MBPS);
-    Time packetTime = m_channel->GetDataRate().CalculateBytesTxTime(packet->GetSize());
+    Time phyTime = Seconds(PlcpHeader::SERIALIZED_SIZE * 8.0 / _1MBPS);
+    Time packetTime = m_airtimeRate.CalculateBytesTxTime(size + PlcpHeader::SERIALIZED_SIZE);
     return phyTime + packetTime;
 }
 
 Time
 WirelessPhy::GetTransmissionTime(Ptr<const Packet> packet)
 {   
-    auto copy = packet->Copy();
-    PlcpHeader plcp;
-    copy->AddHeader(plcp);
+    return GetTransmissionTime(packet->GetSize());
+}
+
+Time
+WirelessPhy::GetTransmissionTime(uint32_t size)
+{
+    NS_ASSERT(m_channel);
+
+    DataRate rate = m_channel->GetDataRate();
+    if (!m_airtime || rate != m_airtimeRate) {
+        m_airtime = &GetAirtimeTable(rate);
+        m_airtimeRate = rate;
+    }
+
+    if (size >= MAX_AIRTIME_ENTRIES) {
+        return GetPacketTime(size);
+    }
+
+    std::vector<Time> &airtime = *m_airtime;
+    if (size >= airtime.size()) {
+        uint32_t first = airtime.size();
+        airtime.resize(size + 1);
+        for (uint32_t i = first; i <= size; i++) {
+            airtime[i] = GetPacketTime(i);
+        }
+    }
+
+    return airtime[size];
+}
+
+std::vector<Time> &
+WirelessPhy::GetAirtimeTable(DataRate rate)
+{
+    // Never destroyed, like the object pools; map nodes keep their
+    // address, so PHYs can hold on to a table.
+    static std::map< uint64_t, std::vector<Time> > *tables = new std::map< uint64_t, std::vector<Time> >;
+    return (*tables)[rate.GetBitRate()];
+}
+
+
+void
+WirelessPhy::SetLinkErrorRate(uint32_t senderNodeId, double per, double ber)
+{
+    NS_ASSERT(per >= 0.0 && per <= 1.0 && ber >= 0.0 && ber <= 1.0);
+    LinkErrorModel &link = m_linkErrors[senderNodeId];
+    link.per = per;
+    link.ber = ber;
+    UpdateHazard(link);
+    UpdateErrorModel();
+}
+
+void
+WirelessPhy::SetPacketErrorRate(double per)
+{
+    m_defaultLink.per = per;
+    UpdateHazard(m_defaultLink);
+    UpdateErrorModel();
+}
+
+double
+WirelessPhy::GetPacketErrorRate(void) const
+{
+    return m_defaultLink.per;
+}
 
-    return GetPacketTime(copy);
+void
+WirelessPhy::SetBitErrorRate(double ber)
+{
+    m_defaultLink.ber = ber;
+    UpdateHazard(m_defaultLink);
+    UpdateErrorModel();
+}
+
+double
+WirelessPhy::GetBitErrorRate(void) const
+{
+    return m_defaultLink.ber;
 }
 
+void
+WirelessPhy::UpdateErrorModel(void)
+{
+    m_useErrorModel = (m_defaultLink.per > 0.0 || m_defaultLink.ber > 0.0);
+    for (auto &link : m_linkErrors) {
+        if (link.second.per > 0.0 || link.second.ber > 0.0) {
+            m_useErrorModel = true;
+        }
+    }
+}
+
+void
+WirelessPhy::UpdateHazard(LinkErrorModel &link)
+{
+    // log1p(-1) is -inf, so a rate of one makes every frame a loss
+    link.base = -std::log1p(-link.per);
+    link.perByte = -8.0 * std::log1p(-link.ber);
+}
+
+double
+WirelessPhy::GetHazard(const LinkErrorModel &link, uint32_t size)
+{
+    return link.base + link.perByte * size;
+}
+
+bool
+WirelessPhy::IsErrored(Ptr<const TransmissionVector> rxVector)
+{
+    if (!m_useErrorModel) {
+        return false;
+    }
+
+    LinkErrorModel *link = &m_defaultLink;
+    if (!m_linkErrors.empty()) {
+        auto found = m_linkErrors.find(rxVector->GetDevice()->GetNode()->GetId());
+        if (found != m_linkErrors.end()) {
+            link = &found->second;
+        }
+    }
+
+    double hazard = GetHazard(*link, rxVector->GetPacket()->GetSize());
+    if (hazard == 0.0) {
+        return false;
+    }
+
+    if (m_errorClock < 0.0) {
+        m_errorClock = -std::log1p(-m_rng->GetValue());
+    }
+
+    m_errorClock -= hazard;
+    if (m_errorClock > 0.0) {
+        return false;
+    }
+
+    NS_LOG_DEBUG("Frame lost to the error model");
+    m_errorClock = -std::log1p(-m_rng->GetValue());
+    return true;
+}
 
 Time
 WirelessPhy::GetInterframeGap(void)
@@ -1,10 +1,14 @@
 #ifndef WIRELESS_PHY_H
 #define WIRELESS_PHY_H
 
-#include <list>
+#include <deque>
+#include <vector>
+#include <unordered_map>
 #include <ns3/object.h>
 #include <ns3/channel.h>
 #include <ns3/mobility-model.h>
+#include <ns3/random-variable-stream.h>
+#include <ns3/data-rate.h>
 
 #include "ns3/wireless-transmission-vector.h"
 #include "ns3/wireless-channel.h"
@@ -33,35 +37,138 @@ public:
 
 	void SetMacUpcalls(Ptr<WirelessMacUpcalls> upcalls);
     void SetPhyUpcalls(Ptr<WirelessPhyUpcalls> upcalls);
+
+    int64_t AssignStreams(int64_t stream);
     
 	bool Send(Ptr<Packet> pkt);
+	bool Send(Ptr<Packet> pkt, Mac48Address destination);
+
+    /*
+     * Encapsulate returns a copy of the packet with the PLCP header added,
+     * which SendFrame transmits as is. A MAC can keep the framed packet
+     * and send it again on a retry without reframing it.
+     */
+    Ptr<Packet> Encapsulate(Ptr<const Packet> pkt) const;
+    bool SendFrame(Ptr<const Packet> frame, Mac48Address destination);
+
+    /*
+     * Frames addressed elsewhere may be pruned by the channel unless the
+     * PHY is promiscuous (see WirelessChannel::PruneReceivers).
+     */
+    void SetReceiveFilter(Mac48Address address, bool promiscuous);
 
     void StartTransmit(Ptr<const TransmissionVector> txVector);
     void FinishTransmit(Ptr<const TransmissionVector> txVector);
 
-    void StartReceive(Ptr<const TransmissionVector> rxVector);
-    void FinishReceive(Ptr<const TransmissionVector> rxVector);
+    uint32_t Reserve(void);
+    void StartReceive(Ptr<const TransmissionVector> rxVector, uint32_t handle);
+    void FinishReceive(Ptr<const TransmissionVector> rxVector, uint32_t handle);
+    void AddInterference(Time start, Time end);
 
     
+    /*
+     * Overrides PacketErrorRate and BitErrorRate for frames received
+     * from the given node.
+     */
+    void SetLinkErrorRate(uint32_t senderNodeId, double per, double ber);
+
+    void SetPacketErrorRate(double per);
+    double GetPacketErrorRate(void) const;
+    void SetBitErrorRate(double ber);
+    double GetBitErrorRate(void) const;
+
     Time GetInterframeGap(void);
     Time GetTransmissionTime(Ptr<const Packet> packet); 
+    Time GetTransmissionTime(uint32_t size);
     bool IsIdle(void);
     bool IsTransmitting(void);
     bool IsReceiving(void);
 
 private:
-    Time GetPacketTime(Ptr<const Packet> packet);
-
-    std::list < Ptr<TransmissionUnit> > m_transmissions;
+    Time GetPacketTime(uint32_t size) const;
+
+    /*
+     * Airtime of a frame indexed by its size before the PLCP header is
+     * added. There is one table per data rate, shared by every PHY in the
+     * process and filled on demand; m_airtime points at the one for the
+     * channel's current rate.
+     */
+    static std::vector<Time> &GetAirtimeTable(DataRate rate);
+    std::vector<Time> *m_airtime;
+    DataRate m_airtimeRate;
+
+    void Release(uint32_t handle);
+
+    /*
+     * Receive-side losses. A link's frame error rate for a frame of s
+     * bytes is 1 - (1 - per)(1 - ber)^(8s), so its hazard -ln(1 - PER)
+     * is affine in s: -ln(1 - per) - 8s ln(1 - ber). Each link keeps the
+     * two coefficients and the hazard is evaluated at the frame's size.
+     *
+     * Rather than drawing once per frame, the PHY draws an Exp(1) clock
+     * and charges every delivered frame its hazard against it. The frame
+     * that runs the clock out is lost and a new clock is drawn; the clock
+     * is memoryless, so each frame is lost independently with the PER of
+     * its size, but draws are only made on loss.
+     */
+    struct LinkErrorModel
+    {
+        double per;
+        double ber;
+        double base;      /* -ln(1 - per) */
+        double perByte;   /* -8 ln(1 - ber) */
+    };
+
+    bool IsErrored(Ptr<const TransmissionVector> rxVector);
+    static void UpdateHazard(LinkErrorModel &link);
+    static double GetHazard(const LinkErrorModel &link, uint32_t size);
+    void UpdateErrorModel(void);
+
+    LinkErrorModel m_defaultLink;
+    std::unordered_map<uint32_t, LinkErrorModel> m_linkErrors;
+    bool m_useErrorModel;
+    double m_errorClock;
+
+    /*
+     * Receptions are slots in m_units addressed by the handle the channel
+     * got from Reserve; m_receiving counts the slots that have started.
+     *
+     * m_epoch advances whenever a collision hits every reception in
+     * progress (an overlapping arrival or our own transmission), so a
+     * reception that sees the epoch move past its starting value before
+     * it finishes was corrupted.
+     */
+    std::vector<TransmissionUnit> m_units;
+    std::vector<uint32_t> m_free;
+    uint32_t m_receiving;
+    uint64_t m_epoch;
+
+    /*
+     * Arrival intervals of frames pruned by the channel, kept as a min-heap
+     * on their end. A reception that overlaps one of them collided with it.
+     *
+     * m_rxStarts lists (start, handle) of receptions in arrival order and
+     * drops finished ones from its front, so it begins with the oldest
+     * reception in progress; intervals ending before that are popped off
+     * the top of the heap.
+     */
+    bool IsInterfered(Time start, Time end) const;
+    void PurgeInterference(void);
+    std::vector< std::pair<Time, Time> > m_interference;
+    std::deque< std::pair<Time, uint32_t> > m_rxStarts;
+
+    bool m_hasFilter;
+    Mac48Address m_filterAddress;
+    bool m_promiscuous;
     Ptr<WirelessChannel> m_channel;
     Ptr<NetDevice> m_device;
     Ptr<MobilityModel> m_mobility;
     Ptr<WirelessMacUpcalls> m_macUpcalls;
     Ptr<WirelessPhyUpcalls> m_phyUpcalls;
+    Ptr<UniformRandomVariable> m_rng;
 
     int m_state;
     bool m_sensing;
-    double m_per;
     bool m_enableCollisions;
 
 }; 
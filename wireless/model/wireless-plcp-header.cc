@@ -51,13 +51,13 @@ PlcpHeader::Print (std::ostream &os) const{
 uint32_t 
 PlcpHeader::GetSize(void)
 {
-    return 24;
+    return SERIALIZED_SIZE;
 }
 
 uint32_t 
 PlcpHeader::GetSerializedSize (void) const
 {
-    return 24;
+    return SERIALIZED_SIZE;
 }
 
 uint32_t
@@ -12,6 +12,8 @@ class PlcpHeader : public Header {
 
 public: 
 
+    static constexpr uint32_t SERIALIZED_SIZE = 24;
+
     PlcpHeader();
     ~PlcpHeader();
 
@@ -0,0 +1,98 @@
+#include "ns3/wireless-range-filter.h"
+
+#include <cmath>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define WIRELESS_RANGE_FILTER_AVX2
+#include <immintrin.h>
+#endif
+
+namespace ns3 {
+
+static void
+FindInRangeScalar(const double *x, const double *y, const double *z,
+				uint32_t first, uint32_t n,
+				double px, double py, double pz,
+				double range,
+				std::vector<uint32_t> &result)
+{
+	for (uint32_t i = first; i < n; i++)
+	{
+		double dx = px - x[i];
+		double dy = py - y[i];
+		double dz = pz - z[i];
+		if (std::sqrt(dx * dx + dy * dy + dz * dz) <= range)
+		{
+			result.push_back(i);
+		}
+	}
+}
+
+#ifdef WIRELESS_RANGE_FILTER_AVX2
+
+__attribute__((target("avx2")))
+static uint32_t
+FindInRangeAvx2(const double *x, const double *y, const double *z,
+				uint32_t n,
+				double px, double py, double pz,
+				double range,
+				std::vector<uint32_t> &result)
+{
+	const __m256d vx = _mm256_set1_pd(px);
+	const __m256d vy = _mm256_set1_pd(py);
+	const __m256d vz = _mm256_set1_pd(pz);
+	const __m256d vr = _mm256_set1_pd(range);
+
+	uint32_t i = 0;
+	for (; i + 4 <= n; i += 4)
+	{
+		__m256d dx = _mm256_sub_pd(vx, _mm256_loadu_pd(x + i));
+		__m256d dy = _mm256_sub_pd(vy, _mm256_loadu_pd(y + i));
+		__m256d dz = _mm256_sub_pd(vz, _mm256_loadu_pd(z + i));
+
+		// separate multiplies and adds, no FMA, to round like the scalar path
+		__m256d d2 = _mm256_add_pd(
+			_mm256_add_pd(_mm256_mul_pd(dx, dx), _mm256_mul_pd(dy, dy)),
+			_mm256_mul_pd(dz, dz));
+		__m256d hit = _mm256_cmp_pd(_mm256_sqrt_pd(d2), vr, _CMP_LE_OQ);
+
+		int mask = _mm256_movemask_pd(hit);
+		while (mask)
+		{
+			int lane = __builtin_ctz(mask);
+			result.push_back(i + lane);
+			mask &= mask - 1;
+		}
+	}
+	return i;
+}
+
+static bool
+HasAvx2(void)
+{
+	static const bool supported = __builtin_cpu_supports("avx2");
+	return supported;
+}
+
+#endif
+
+void
+FindInRange(const double *x, const double *y, const double *z,
+			uint32_t n,
+			double px, double py, double pz,
+			double range,
+			std::vector<uint32_t> &result)
+{
+	uint32_t first = 0;
+
+#ifdef WIRELESS_RANGE_FILTER_AVX2
+	if (HasAvx2())
+	{
+		first = FindInRangeAvx2(x, y, z, n, px, py, pz, range, result);
+	}
+#endif
+
+	FindInRangeScalar(x, y, z, first, n, px, py, pz, range, result);
+}
+
+} /* namespace ns3 */
@@ -0,0 +1,27 @@
+#ifndef WIRELESS_RANGE_FILTER_H
+#define WIRELESS_RANGE_FILTER_H
+
+#include <stdint.h>
+#include <vector>
+
+namespace ns3 {
+
+/*
+ * Appends to result, in ascending order, the index of every position in
+ * the structure-of-arrays (x, y, z) whose Euclidean distance from
+ * (px, py, pz) is at most range.
+ *
+ * The squared distance is computed four lanes at a time with AVX2 when
+ * the CPU supports it, and then compared after a vector square root so
+ * the outcome matches MobilityModel::GetDistanceFrom bit for bit. Other
+ * targets use the equivalent scalar loop.
+ */
+void FindInRange(const double *x, const double *y, const double *z,
+				uint32_t n,
+				double px, double py, double pz,
+				double range,
+				std::vector<uint32_t> &result);
+
+} /* namespace ns3 */
+
+#endif /* WIRELESS_RANGE_FILTER_H */
@@ -0,0 +1,270 @@
+#include "ns3/node.h"
+#include "ns3/net-device.h"
+#include "ns3/log.h"
+#include "ns3/abort.h"
+#include <ns3/simulator.h>
+#include "ns3/mpi-interface.h"
+#include "ns3/mpi-receiver.h"
+#include "ns3/wireless-remote-channel.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if __has_include("ns3/distributed-simulator-impl.h")
+#define WIRELESS_REMOTE_BOUND_LOOKAHEAD
+#include "ns3/distributed-simulator-impl.h"
+#endif
+
+namespace ns3 {
+
+NS_LOG_COMPONENT_DEFINE ("WirelessRemoteChannel");
+NS_OBJECT_ENSURE_REGISTERED (WirelessRemoteHeader);
+NS_OBJECT_ENSURE_REGISTERED (WirelessRemoteChannel);
+
+WirelessRemoteHeader::WirelessRemoteHeader()
+: m_sender(0), m_receiver(0), m_duration(0), m_corrupted(0)
+{
+}
+
+WirelessRemoteHeader::WirelessRemoteHeader(uint32_t sender, uint32_t receiver, Time duration, bool corrupted)
+: m_sender(sender), m_receiver(receiver), m_duration(duration.GetTimeStep()), m_corrupted(corrupted)
+{
+}
+
+WirelessRemoteHeader::~WirelessRemoteHeader(){
+}
+
+TypeId
+WirelessRemoteHeader::GetTypeId(void)
+{
+	static TypeId tid = TypeId ("ns3::WirelessRemoteHeader")
+		.SetParent<Header> ()
+		.SetGroupName ("Wireless")
+		.AddConstructor<WirelessRemoteHeader> ()
+	;
+	return tid;
+}
+
+TypeId
+WirelessRemoteHeader::GetInstanceTypeId (void) const
+{
+	return GetTypeId();
+}
+
+void
+WirelessRemoteHeader::Print (std::ostream &os) const
+{
+	os << "[sender = " << m_sender << ", receiver = " << m_receiver
+	   << ", duration = " << m_duration << ", corrupted = " << (int) m_corrupted << "]";
+}
+
+uint32_t
+WirelessRemoteHeader::GetSerializedSize (void) const
+{
+	return 17;
+}
+
+void
+WirelessRemoteHeader::Serialize (Buffer::Iterator start) const
+{
+	start.WriteHtonU32(m_sender);
+	start.WriteHtonU32(m_receiver);
+	start.WriteHtonU64(m_duration);
+	start.WriteU8(m_corrupted);
+}
+
+uint32_t
+WirelessRemoteHeader::Deserialize (Buffer::Iterator start)
+{
+	m_sender = start.ReadNtohU32();
+	m_receiver = start.ReadNtohU32();
+	m_duration = start.ReadNtohU64();
+	m_corrupted = start.ReadU8();
+	return GetSerializedSize();
+}
+
+uint32_t
+WirelessRemoteHeader::GetSender(void) const
+{
+	return m_sender;
+}
+
+uint32_t
+WirelessRemoteHeader::GetReceiver(void) const
+{
+	return m_receiver;
+}
+
+Time
+WirelessRemoteHeader::GetDuration(void) const
+{
+	return TimeStep(m_duration);
+}
+
+bool
+WirelessRemoteHeader::IsCorrupted(void) const
+{
+	return m_corrupted != 0;
+}
+
+TypeId
+WirelessRemoteChannel::GetTypeId (void)
+{
+	static TypeId tid = TypeId ("ns3::WirelessRemoteChannel")
+					.SetParent<WirelessChannel> ()
+					.SetGroupName ("Wireless")
+					.AddConstructor<WirelessRemoteChannel> ();
+	return tid;
+}
+
+WirelessRemoteChannel::WirelessRemoteChannel ()
+{
+	m_bound = false;
+	m_systemId = 0;
+	m_lookAhead = Time::Max();
+}
+
+WirelessRemoteChannel::~WirelessRemoteChannel (void)
+{
+}
+
+uint32_t
+WirelessRemoteChannel::GetPartition(const Vector &position, double minX, double maxX, uint32_t partitions)
+{
+	NS_ASSERT(partitions > 0);
+	if (maxX <= minX)
+	{
+		return 0;
+	}
+
+	double strip = std::floor((position.x - minX) / (maxX - minX) * partitions);
+	return static_cast<uint32_t>(std::min(std::max(strip, 0.0), partitions - 1.0));
+}
+
+void
+WirelessRemoteChannel::Bind(void)
+{
+	NS_LOG_FUNCTION (this);
+	NS_ASSERT_MSG(!m_bound, "Channel is already bound");
+
+	uint32_t size = 1;
+	if (MpiInterface::IsEnabled())
+	{
+		m_systemId = MpiInterface::GetSystemId();
+		size = MpiInterface::GetSize();
+	}
+
+	NS_ABORT_MSG_UNLESS(UpdateTopology(), "WirelessRemoteChannel requires stationary nodes");
+
+	std::size_t n = GetNDevices();
+	m_remote.assign(n, false);
+	m_ifIndex.assign(n, 0);
+
+	for (uint32_t i = 0; i < n; i++)
+	{
+		Ptr<NetDevice> device = GetPhy(i)->GetDevice();
+		m_remote[i] = (device->GetNode()->GetSystemId() != m_systemId);
+		m_ifIndex[i] = device->GetIfIndex();
+
+		// Remote ranks deliver through an MpiReceiver aggregated to the
+		// destination device; the header says which PHY it is for.
+		if (!m_remote[i] && !device->GetObject<MpiReceiver>())
+		{
+			Ptr<MpiReceiver> receiver = CreateObject<MpiReceiver>();
+			receiver->SetReceiveCallback(MakeCallback(&WirelessRemoteChannel::ReceiveRemote, this));
+			device->AggregateObject(receiver);
+		}
+	}
+
+	// Lookahead is the shortest delay of any in-range link between a local
+	// and a remote node, in either direction.
+	m_lookAhead = Time::Max();
+	for (uint32_t i = 0; i < n; i++)
+	{
+		if (m_remote[i])
+		{
+			continue;
+		}
+
+		GetReceivers(i, m_receivers);
+		for (uint32_t j : m_receivers)
+		{
+			if (m_remote[j])
+			{
+				m_lookAhead = std::min(m_lookAhead, std::min(GetDelay(i, j), GetDelay(j, i)));
+			}
+		}
+	}
+
+	NS_LOG_INFO("Rank " << m_systemId << " lookahead " << m_lookAhead);
+
+	if (size > 1 && m_lookAhead != Time::Max())
+	{
+		NS_ABORT_MSG_UNLESS(m_lookAhead.IsStrictlyPositive(),
+			"Nodes in range of each other on different ranks must not be co-located");
+
+#ifdef WIRELESS_REMOTE_BOUND_LOOKAHEAD
+		Ptr<DistributedSimulatorImpl> impl = DynamicCast<DistributedSimulatorImpl>(Simulator::GetImplementation());
+		NS_ABORT_MSG_UNLESS(impl, "WirelessRemoteChannel requires ns3::DistributedSimulatorImpl");
+		impl->BoundLookAhead(m_lookAhead);
+#else
+		NS_FATAL_ERROR("This ns-3 build does not export DistributedSimulatorImpl, so the "
+			"channel lookahead cannot be applied");
+#endif
+	}
+
+	m_bound = true;
+}
+
+Time
+WirelessRemoteChannel::GetLookAhead(void) const
+{
+	return m_lookAhead;
+}
+
+void
+WirelessRemoteChannel::ScheduleReception(uint32_t sender,
+								uint32_t receiver,
+								Time delay,
+								Ptr<const TransmissionVector> txVector)
+{
+	if (!m_bound || !m_remote[receiver])
+	{
+		WirelessChannel::ScheduleReception(sender, receiver, delay, txVector);
+		return;
+	}
+
+	Ptr<Packet> packet = txVector->GetPacket()->Copy();
+	WirelessRemoteHeader header(sender, receiver, txVector->GetDuration(), txVector->ShouldBeCorrupted());
+	packet->AddHeader(header);
+
+	NS_LOG_DEBUG("Forwarding to node " << GetNodeId(receiver) << " arriving at " << Simulator::Now() + delay);
+	MpiInterface::SendPacket(packet, Simulator::Now() + delay, GetNodeId(receiver), m_ifIndex[receiver]);
+}
+
+void
+WirelessRemoteChannel::ReceiveRemote(Ptr<Packet> packet)
+{
+	WirelessRemoteHeader header;
+	packet->RemoveHeader(header);
+
+	NS_ASSERT(header.GetSender() < GetNDevices() && header.GetReceiver() < GetNDevices());
+	Ptr<WirelessPhyUpcalls> sender = GetPhy(header.GetSender());
+	Ptr<WirelessPhyUpcalls> receiver = GetPhy(header.GetReceiver());
+
+	Ptr<TransmissionVector> rxVector = Create<TransmissionVector>(
+		packet,
+		sender->GetDevice(),
+		sender->GetMobility(),
+		header.GetDuration(),
+		header.IsCorrupted()
+	);
+
+	// MpiInterface already delivers at the arrival time in the receiver's
+	// context, so only the end of the reception is left to schedule.
+	uint32_t handle = receiver->Reserve();
+	StartReceive(receiver, rxVector, handle);
+	Simulator::Schedule(header.GetDuration(), &WirelessRemoteChannel::FinishReceive, this, receiver, rxVector, handle);
+}
+
+} // namespace ns3
@@ -0,0 +1,99 @@
+#ifndef WIRELESS_REMOTE_CHANNEL_H
+#define WIRELESS_REMOTE_CHANNEL_H
+
+#include <stdint.h>
+#include <vector>
+#include "ns3/header.h"
+#include "ns3/nstime.h"
+#include "ns3/vector.h"
+#include "ns3/wireless-channel.h"
+
+namespace ns3 {
+
+/*
+ * Prepended to a frame that crosses a partition boundary, so the remote
+ * rank can rebuild the transmission vector. Channel indices are valid on
+ * every rank because each rank attaches the same PHYs in the same order.
+ */
+class WirelessRemoteHeader : public Header {
+
+public:
+
+    WirelessRemoteHeader();
+    WirelessRemoteHeader(uint32_t sender, uint32_t receiver, Time duration, bool corrupted);
+    ~WirelessRemoteHeader();
+
+    static TypeId GetTypeId (void);
+    virtual TypeId GetInstanceTypeId (void) const;
+    virtual void Print (std::ostream &os) const;
+    virtual uint32_t GetSerializedSize (void) const;
+    virtual void Serialize (Buffer::Iterator start) const;
+    virtual uint32_t Deserialize (Buffer::Iterator start);
+
+    uint32_t GetSender(void) const;
+    uint32_t GetReceiver(void) const;
+    Time GetDuration(void) const;
+    bool IsCorrupted(void) const;
+
+private:
+
+    uint32_t m_sender;
+    uint32_t m_receiver;
+    int64_t m_duration;
+    uint8_t m_corrupted;
+
+}; /* class WirelessRemoteHeader */
+
+/*
+ * A WirelessChannel for conservative distributed simulation with
+ * DistributedSimulatorImpl. Every rank builds the whole topology, with
+ * each node's system id naming the rank that owns it (see GetPartition).
+ * Receptions at local nodes are scheduled as usual; receptions at nodes
+ * owned by another rank are forwarded through MpiInterface and replayed
+ * there on arrival.
+ *
+ * The smallest propagation delay between in-range nodes on different
+ * ranks bounds the simulator lookahead, so Bind must be called after all
+ * devices are installed and before Simulator::Run. Nodes are expected to
+ * be stationary.
+ */
+class WirelessRemoteChannel : public WirelessChannel
+{
+public:
+
+	static TypeId GetTypeId (void);
+
+	WirelessRemoteChannel();
+	virtual ~WirelessRemoteChannel (void);
+
+	void Bind(void);
+	Time GetLookAhead(void) const;
+
+	/*
+	 * Rank owning a node at the given position when [minX, maxX] is
+	 * split into equal-width strips, one per rank.
+	 */
+	static uint32_t GetPartition(const Vector &position, double minX, double maxX, uint32_t partitions);
+
+protected:
+
+	virtual void ScheduleReception(uint32_t sender,
+				uint32_t receiver,
+				Time delay,
+				Ptr<const TransmissionVector> txVector);
+
+private:
+
+	void ReceiveRemote(Ptr<Packet> packet);
+
+	bool m_bound;
+	uint32_t m_systemId;
+	Time m_lookAhead;
+	std::vector<bool> m_remote;
+	std::vector<uint32_t> m_ifIndex;
+	std::vector<uint32_t> m_receivers;
+};
+
+} // namespace ns3
+
+#endif /* WIRELESS_REMOTE_CHANNEL_H */
@@ -2,16 +2,22 @@
 
 namespace ns3 {
 
-TransmissionUnit::TransmissionUnit(Ptr<const TransmissionVector> rxVector)
+TransmissionUnit::TransmissionUnit()
+{
+    m_rxVector = 0;
+    m_corrupted = false;
+    m_epoch = 0;
+}
+
+TransmissionUnit::TransmissionUnit(Ptr<const TransmissionVector> rxVector, uint64_t epoch, Time start)
 {
     m_rxVector = rxVector;
     m_corrupted = rxVector->ShouldBeCorrupted();
+    m_epoch = epoch;
+    m_start = start;
     
 }
 
-TransmissionUnit::~TransmissionUnit(){
-}
-
 Ptr<const TransmissionVector>
 TransmissionUnit::GetTransmissionVector(void) const
 {
@@ -30,4 +36,16 @@ TransmissionUnit::Corrupt(void)
     m_corrupted = true;
 }
 
+uint64_t
+TransmissionUnit::GetEpoch(void) const
+{
+    return m_epoch;
+}
+
+Time
+TransmissionUnit::GetStart(void) const
+{
+    return m_start;
+}
+
 } /* namespace ns3 */
\ No newline at end of file
@@ -5,24 +5,34 @@
 
 namespace ns3 {
 
-class TransmissionUnit: public SimpleRefCount<TransmissionUnit>
+/*
+ * One reception in progress at a PHY. Units are held by value in the
+ * PHY's reception table and addressed by handle.
+ */
+class TransmissionUnit
 {
     public:
 
-        TransmissionUnit(Ptr<const TransmissionVector> rxVector);
-        virtual ~TransmissionUnit();
+        TransmissionUnit();
+        TransmissionUnit(Ptr<const TransmissionVector> rxVector, uint64_t epoch, Time start);
 
         Ptr<const TransmissionVector> GetTransmissionVector(void) const;
         bool IsCorrupted(void) const;
         void Corrupt(void);
 
+        /* collision epoch of the PHY when the reception started */
+        uint64_t GetEpoch(void) const;
+        Time GetStart(void) const;
+
     private:
 
         Ptr<const TransmissionVector> m_rxVector;
         bool m_corrupted;
+        uint64_t m_epoch;
+        Time m_start;
         
 };
 
 } /* namespace ns3 */
 
-#endif /* WIRELESS_TRANSMISSION_UNIT_H */
\ No newline at end of file
+#endif /* WIRELESS_TRANSMISSION_UNIT_H */
@@ -9,23 +9,25 @@ namespace ns3 {
 NS_LOG_COMPONENT_DEFINE ("WirelessTransmissionVector");
 
 TransmissionVector::TransmissionVector(
-    Ptr<Packet> pkt,
+    Ptr<const Packet> pkt,
     Ptr<NetDevice> device,
     Ptr<MobilityModel> mobility,
     Time duration,
-    bool shouldBeCorrupted)
+    bool shouldBeCorrupted,
+    Mac48Address destination)
     {
         m_pkt = pkt;
         m_device = device;
         m_mobility = mobility;
         m_duration = duration;
         m_shouldBeCorrupted = shouldBeCorrupted;
+        m_destination = destination;
     }
 
 TransmissionVector::~TransmissionVector (void) {
 }
 
-Ptr<Packet>
+Ptr<const Packet>
 TransmissionVector::GetPacket (void) const
 {
     NS_ASSERT(m_pkt);
@@ -52,6 +54,12 @@ TransmissionVector::ShouldBeCorrupted (void) const
     return m_shouldBeCorrupted;
 }
 
+Mac48Address
+TransmissionVector::GetDestination (void) const
+{
+    return m_destination;
+}
+
 Time
 TransmissionVector::GetDuration (void) const
 {
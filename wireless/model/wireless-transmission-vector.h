@@ -5,6 +5,8 @@
 #include <ns3/net-device.h>
 #include "ns3/nstime.h"
 #include "ns3/mobility-model.h"
+#include "ns3/mac48-address.h"
+#include "ns3/wireless-object-pool.h"
 #include "ns3/log.h"
 
 namespace ns3 {
@@ -14,28 +16,36 @@ class TransmissionVector : public SimpleRefCount<TransmissionVector>
 public:
     
     TransmissionVector(
-        Ptr<Packet> pkt,
+        Ptr<const Packet> pkt,
         Ptr<NetDevice> device,
         Ptr<MobilityModel> m_mobility,
         Time duration,
-        bool shouldBeCorrupted
+        bool shouldBeCorrupted,
+        Mac48Address destination = Mac48Address::GetBroadcast()
     );
     
     virtual ~TransmissionVector();
 
-    Ptr<Packet> GetPacket (void) const;
+    /* one vector per transmission, so they are recycled through a pool */
+    typedef WirelessObjectPool<TransmissionVector> Pool;
+    static void *operator new(std::size_t size) { return Pool::Allocate(size); }
+    static void operator delete(void *block, std::size_t size) { Pool::Release(block, size); }
+
+    Ptr<const Packet> GetPacket (void) const;
     Ptr<NetDevice> GetDevice (void) const;
     Ptr<MobilityModel> GetMobility (void) const;
     Time GetDuration (void) const;
     bool ShouldBeCorrupted (void) const;
+    Mac48Address GetDestination (void) const;
 
 
 private:
-    Ptr<Packet> m_pkt;
+    Ptr<const Packet> m_pkt;
     Ptr<NetDevice> m_device;
     Ptr<MobilityModel> m_mobility;
     Time m_duration;
     bool m_shouldBeCorrupted;
+    Mac48Address m_destination;
 };
 
 } /* namespace ns3 */